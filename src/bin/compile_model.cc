@@ -0,0 +1,88 @@
+#include <ckylark/LAPCFGParser.h>
+#include <ckylark/Timer.h>
+#include <ckylark/Tracer.h>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+using namespace boost;
+using namespace Ckylark;
+
+namespace PO = boost::program_options;
+
+PO::variables_map parseOptions(int argc, char * argv[]) {
+    string description = "Ckylark model compiler - converts Berkeley dumps into binary model files.";
+    string binname = "ckylark-compile-model";
+
+    // generic options
+    PO::options_description opt_generic("Generic Options");
+    opt_generic.add_options()
+        ("help", "print this manual and exit")
+        ("trace-level", PO::value<int>()->default_value(1), "detail level of tracing text")
+        ;
+    // input/output
+    PO::options_description opt_io("I/O Options");
+    opt_io.add_options()
+        ("model", PO::value<string>(), "(required) prefix of model path")
+        ("output", PO::value<string>(), "(required) binary model file")
+        ;
+    // settings baked into the binary model
+    PO::options_description opt_parsing("Parsing Options");
+    opt_parsing.add_options()
+        ("smooth-unklex", PO::value<double>()->default_value(1e-10), "smoothing strength using UNK lexicon")
+        ("scaling", PO::value<string>()->default_value("harmonic"), "scaling strategy\n(candidates: 'max', 'geometric', 'harmonic')")
+        ;
+
+    PO::options_description opt;
+    opt.add(opt_generic).add(opt_io).add(opt_parsing);
+
+    // parse
+    PO::variables_map args;
+    PO::store(PO::parse_command_line(argc, argv, opt), args);
+    PO::notify(args);
+
+    // process usage
+    if (args.count("help")) {
+        cerr << description << endl;
+        cerr << "Usage: " << binname << " [options] --model MODEL_PREFIX --output BINARY_MODEL" << endl;
+        cerr << "The binary model must be used with the same --smooth-unklex and --scaling." << endl;
+        cerr << opt << endl;
+        exit(1);
+    }
+
+    // check required options
+    if (!args.count("model") || !args.count("output")) {
+        cerr << "ERROR: insufficient required options" << endl;
+        cerr << "(--help to show usage)" << endl;
+        exit(1);
+    }
+
+    return args;
+}
+
+int main(int argc, char * argv[]) {
+
+    auto args = parseOptions(argc, argv);
+
+    Tracer::setTraceLevel(args["trace-level"].as<int>());
+
+    Timer timer;
+    timer.start();
+
+    std::shared_ptr<LAPCFGParser> parser = LAPCFGParser::loadFromBerkeleyDump(
+        args["model"].as<string>(),
+        args["smooth-unklex"].as<double>(),
+        args["scaling"].as<string>());
+    Tracer::println(1, (format("Loading time: %.3fs.") % timer.stop()).str());
+
+    timer.start();
+    parser->saveToBinary(args["output"].as<string>());
+    Tracer::println(1, (format("Writing time: %.3fs.") % timer.stop()).str());
+
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <ckylark/BoundedQueue.h>
 #include <ckylark/FormatterFactory.h>
 #include <ckylark/Mapping.h>
 #include <ckylark/Timer.h>
@@ -12,12 +13,15 @@
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
 
+#include <algorithm>
 #include <cstdio>
 #include <cmath>
+#include <exception>
 #include <fstream>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
@@ -34,12 +38,14 @@ PO::variables_map parseOptions(int argc, char * argv[]) {
     PO::options_description opt_generic("Generic Options");
     opt_generic.add_options()
         ("help", "print this manual and exit")
-        ("trace-level", PO::value<int>()->default_value(0), "detail level of tracing text");
+        ("trace-level", PO::value<int>()->default_value(0), "detail level of tracing text")
+        ("threads", PO::value<int>()->default_value(1), "number of parsing threads, or 0 (use all hardware threads)")
+        ("span-threads", PO::value<int>()->default_value(1), "number of threads to parse each sentence, or 0 (use all hardware threads)")
         ;
     // input/output
     PO::options_description opt_io("I/O Options");
     opt_io.add_options()
-        ("model", PO::value<string>(), "(required) prefix of model path")
+        ("model", PO::value<string>(), "(required) prefix of model path, or binary model file")
         ("input", PO::value<string>()->default_value("/dev/stdin"), "input file")
         ("output", PO::value<string>()->default_value("/dev/stdout"), "output file")
         ;
@@ -54,6 +60,7 @@ PO::variables_map parseOptions(int argc, char * argv[]) {
         ("partial", "parse partial (grammar tag contained) sentence")
         ("do-m1-preparse", "do preparsing using G-1 grammar/lexicon")
         ("force-generate", "generate list-of-words tree if parsing fails")
+        ("kernel", PO::value<string>()->default_value("auto"), "score kernel\n(candidates: 'auto', 'scalar', 'avx2', 'avx512', 'check')")
         ;
     // formatting
     PO::options_description opt_formatting("Formatting Options");
@@ -90,6 +97,20 @@ PO::variables_map parseOptions(int argc, char * argv[]) {
     return std::move(args);
 }
 
+// one input line and its parsing result
+struct Job {
+    size_t seq; // line number from 0
+    vector<string> words;
+    std::shared_ptr<Tree<string> > best_parse;
+    double lap;
+}; // struct Job
+
+// statistics of each parsing thread
+struct WorkerStats {
+    size_t num_tasks;
+    double busy_time;
+}; // struct WorkerStats
+
 int main(int argc, char * argv[]) {
 
     auto args = parseOptions(argc, argv);
@@ -122,48 +143,167 @@ int main(int argc, char * argv[]) {
     parser_args["scaling"] = args["scaling"].as<string>();
     parser_args["do-m1-preparse"] = !!args.count("do-m1-preparse");
     parser_args["force-generate"] = !!args.count("force-generate");
+    parser_args["kernel"] = args["kernel"].as<string>();
+    parser_args["span-threads"] = args["span-threads"].as<int>();
     std::shared_ptr<Parser> parser = ParserFactory::create(parser_args);
 
-    // make parser setting
-    Timer timer;
+    int num_threads = args["threads"].as<int>();
+    if (num_threads <= 0) {
+        num_threads = thread::hardware_concurrency();
+        if (num_threads <= 0) num_threads = 1;
+    }
+    Tracer::println(1, (format("threads: %d") % num_threads).str());
+
+    // lines flow through 3 stages: reader -> parsers (num_threads) -> writer.
+    // each parsing thread takes the next line as soon as it finishes the previous one,
+    // and the writer restores the input order by sequence numbers.
+    // the reader sorts each READ_WINDOW lines in descending order of parse costs,
+    // so long sentences are not left to the end of the window (unless single-threaded).
+    // at most MAX_IN_FLIGHT lines are read but not yet written, so the memory
+    // usage is bounded regardless of the input size, and I/O runs while parsing.
+    const size_t READ_WINDOW = num_threads > 1 ? 16 * num_threads : 1;
+    const size_t MAX_IN_FLIGHT = 4 * READ_WINDOW;
+    BoundedQueue<Job> input_queue(MAX_IN_FLIGHT);
+    BoundedQueue<Job> output_queue(MAX_IN_FLIGHT);
+    BoundedQueue<int> tickets(MAX_IN_FLIGHT); // 1 ticket for each line in flight
+    for (size_t i = 0; i < MAX_IN_FLIGHT; ++i) tickets.push(0);
+
+    // stop all stages after a failure
+    auto abort_all = [&]() {
+        tickets.close();
+        input_queue.close();
+        output_queue.close();
+    };
+
+    Timer wall_timer;
+    wall_timer.start();
 
     Tracer::println(1, "Ready");
 
-    string line;
     int total_lines = 0;
     int total_words = 0;
-    
-    while (ifs->readLine(line)) {
-        trim(line);
-        vector<string> ls;
-        if (!line.empty()) {
-            split(ls, line, is_space(), boost::algorithm::token_compress_on);
-        }
-        
-        ++total_lines;
-        total_words += ls.size();
-        
-        Tracer::print(1, (format("Input %d:") % total_lines).str());
-        for (const string & s : ls) {
-            Tracer::print(1, " " + s);
+    double total_time = 0.0;
+    exception_ptr reader_error;
+    vector<exception_ptr> parser_error(num_threads);
+    exception_ptr writer_error;
+    vector<WorkerStats> worker_stats(num_threads, WorkerStats { 0, 0.0 });
+
+    // read and tokenize lines
+    thread reader([&]() {
+        try {
+            string line;
+            size_t seq = 0;
+            bool eof = false;
+            while (!eof) {
+                vector<Job> window;
+                int ticket;
+                while (window.size() < READ_WINDOW && tickets.pop(ticket)) {
+                    if (!ifs->readLine(line)) {
+                        eof = true;
+                        break;
+                    }
+                    trim(line);
+                    Job job { seq++, vector<string>(), std::shared_ptr<Tree<string> >(), 0.0 };
+                    if (!line.empty()) {
+                        split(job.words, line, is_space(), boost::algorithm::token_compress_on);
+                    }
+                    window.push_back(std::move(job));
+                }
+                if (window.size() < READ_WINDOW && !eof) break; // other stage failed
+
+                stable_sort(window.begin(), window.end(), [](const Job & a, const Job & b) {
+                    return a.words.size() > b.words.size();
+                });
+                for (Job & job : window) {
+                    if (!input_queue.push(std::move(job))) return; // other stage failed
+                }
+            }
+        } catch (...) {
+            reader_error = current_exception();
+            abort_all();
         }
-        Tracer::println(1);
+        input_queue.close();
+    });
+
+    // format and write results in the input order
+    thread writer([&]() {
+        try {
+            map<size_t, Job> pending; // finished jobs which wait for preceding lines
+            size_t next_seq = 0;
+            Job job;
+            while (output_queue.pop(job)) {
+                pending[job.seq] = std::move(job);
+                for (auto it = pending.find(next_seq); it != pending.end(); it = pending.find(++next_seq)) {
+                    const Job & ready = it->second;
+                    string repr = formatter->generate(*ready.best_parse);
+                    ++total_lines;
+                    total_words += ready.words.size();
+                    total_time += ready.lap;
+
+                    Tracer::print(1, (format("Input %d:") % total_lines).str());
+                    for (const string & s : ready.words) {
+                        Tracer::print(1, " " + s);
+                    }
+                    Tracer::println(1);
+                    Tracer::println(1, "  Parse: " + repr);
+                    Tracer::println(1, (format("  Time: %.3fs") % ready.lap).str());
 
-        timer.start();
-        ParserResult result = parser->parse(ls, setting);
-        double lap = timer.stop();
+                    ofs->writeLine(repr);
+                    pending.erase(it);
+                    tickets.push(0);
+                }
+            }
+        } catch (...) {
+            writer_error = current_exception();
+            abort_all();
+        }
+    });
 
-        string repr = formatter->generate(*result.best_parse);
-        
-        Tracer::println(1, "  Parse: " + repr);
-        Tracer::println(1, (format("  Time: %.3fs") % lap).str());
+    // parse lines by persistent threads sharing one parser
+    vector<thread> workers;
+    for (int i = 0; i < num_threads; ++i) {
+        workers.push_back(thread([&, i]() {
+            try {
+                Timer timer;
+                Job job;
+                while (input_queue.pop(job)) {
+                    timer.start();
+                    ParserResult result = parser->parse(job.words, setting);
+                    job.lap = timer.stop();
+                    job.best_parse = result.best_parse;
+                    worker_stats[i].busy_time += job.lap;
+                    ++worker_stats[i].num_tasks;
+                    if (!output_queue.push(std::move(job))) break; // writer failed
+                }
+            } catch (...) {
+                parser_error[i] = current_exception();
+                abort_all();
+            }
+        }));
+    }
+    for (thread & t : workers) {
+        t.join();
+    }
+    output_queue.close(); // all results are passed to the writer
+    reader.join();
+    writer.join();
 
-        ofs->writeLine(repr);
+    if (reader_error) rethrow_exception(reader_error);
+    for (exception_ptr error : parser_error) {
+        if (error) rethrow_exception(error);
     }
+    if (writer_error) rethrow_exception(writer_error);
 
+    wall_timer.stop();
     Tracer::println(1);
     Tracer::println(1, (format("Parsed %d sentences, %d words.") % total_lines % total_words).str());
-    Tracer::println(1, (format("Total parsing time: %.3fs.") % timer.elapsed()).str());
+    Tracer::println(1, (format("Total parsing time: %.3fs.") % total_time).str());
+    Tracer::println(1, (format("Total wall time: %.3fs.") % wall_timer.elapsed()).str());
+    for (int i = 0; i < num_threads; ++i) {
+        Tracer::println(1, (format("Thread %d: %d sentences, busy %.3fs, utilization %.1f%%")
+            % i % worker_stats[i].num_tasks % worker_stats[i].busy_time
+            % (100.0 * worker_stats[i].busy_time / wall_timer.elapsed())).str());
+    }
 
     return 0;
 }
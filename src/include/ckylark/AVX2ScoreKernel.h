@@ -0,0 +1,36 @@
+#ifndef CKYLARK_AVX2_SCORE_KERNEL_H_
+#define CKYLARK_AVX2_SCORE_KERNEL_H_
+
+#include <ckylark/ScoreKernel.h>
+
+namespace Ckylark {
+
+// implementation using AVX2 and FMA instructions
+class AVX2ScoreKernel : public ScoreKernel {
+
+    AVX2ScoreKernel(const AVX2ScoreKernel &) = delete;
+    AVX2ScoreKernel & operator=(const AVX2ScoreKernel &) = delete;
+
+public:
+    AVX2ScoreKernel() {}
+    ~AVX2ScoreKernel() {}
+
+    std::string getName() const { return "avx2"; }
+
+    double binaryInside(
+        const double * rows, int stride, uint64_t row_mask,
+        const double * left, uint64_t lmask,
+        const double * right, uint64_t rmask) const;
+
+    void binaryOutside(
+        const double * rows, int stride, uint64_t row_mask, double parent,
+        const double * left, uint64_t lmask, double * outside_left,
+        const double * right, uint64_t rmask, double * outside_right) const;
+
+    void accumulate(double * dest, double scale, const double * src, int size) const;
+
+}; // class AVX2ScoreKernel
+
+} // namespace Ckylark
+
+#endif // CKYLARK_AVX2_SCORE_KERNEL_H_
@@ -0,0 +1,36 @@
+#ifndef CKYLARK_AVX512_SCORE_KERNEL_H_
+#define CKYLARK_AVX512_SCORE_KERNEL_H_
+
+#include <ckylark/ScoreKernel.h>
+
+namespace Ckylark {
+
+// implementation using AVX-512F instructions
+class AVX512ScoreKernel : public ScoreKernel {
+
+    AVX512ScoreKernel(const AVX512ScoreKernel &) = delete;
+    AVX512ScoreKernel & operator=(const AVX512ScoreKernel &) = delete;
+
+public:
+    AVX512ScoreKernel() {}
+    ~AVX512ScoreKernel() {}
+
+    std::string getName() const { return "avx512"; }
+
+    double binaryInside(
+        const double * rows, int stride, uint64_t row_mask,
+        const double * left, uint64_t lmask,
+        const double * right, uint64_t rmask) const;
+
+    void binaryOutside(
+        const double * rows, int stride, uint64_t row_mask, double parent,
+        const double * left, uint64_t lmask, double * outside_left,
+        const double * right, uint64_t rmask, double * outside_right) const;
+
+    void accumulate(double * dest, double scale, const double * src, int size) const;
+
+}; // class AVX512ScoreKernel
+
+} // namespace Ckylark
+
+#endif // CKYLARK_AVX512_SCORE_KERNEL_H_
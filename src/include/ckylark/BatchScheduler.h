@@ -0,0 +1,64 @@
+#ifndef CKYLARK_BATCH_SCHEDULER_H_
+#define CKYLARK_BATCH_SCHEDULER_H_
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Ckylark {
+
+// runs tasks with estimated costs on a bounded number of threads.
+// tasks are dealt to per-thread deques with the longest-first rule, and each
+// thread takes the most expensive task of its own deque first. idle threads
+// steal the cheapest task of the most loaded deque.
+// statistics are accumulated over all run() calls.
+// run() can be called from several threads at the same time, and each call
+// uses its own threads. statistics of a call are added when it finishes.
+class BatchScheduler {
+
+    BatchScheduler(const BatchScheduler &) = delete;
+    BatchScheduler & operator=(const BatchScheduler &) = delete;
+
+public:
+    // num_threads <= 0: use all hardware threads
+    explicit BatchScheduler(int num_threads = 0);
+    ~BatchScheduler();
+
+    // call func(index, thread) for each index of costs, and return after all calls.
+    // thread in [0, numThreads()) identifies the calling thread, and can be used
+    // to select per-thread buffers.
+    // if some calls throw, the first exception in the order of indices is rethrown.
+    void run(const std::vector<double> & costs, const std::function<void(size_t, int)> & func);
+
+    // estimated cost of parsing a sentence by CKY
+    static double estimateParseCost(size_t num_words);
+
+    inline int numThreads() const { return num_threads_; }
+
+    size_t getNumTasks(int thread) const;
+    size_t getNumStolen(int thread) const;
+    double getBusyTime(int thread) const;
+    double getWallTime() const;
+
+    // ratio of busy time to wall time of run() calls
+    double getUtilization(int thread) const;
+
+private:
+    struct Stats {
+        size_t num_tasks;
+        size_t num_stolen;
+        double busy_time;
+    }; // struct Stats
+
+    int num_threads_;
+    mutable std::mutex stats_mutex_; // guards stats_ and wall_time_
+    std::vector<Stats> stats_; // [thread]
+    double wall_time_;
+
+}; // class BatchScheduler
+
+} // namespace Ckylark
+
+#endif // CKYLARK_BATCH_SCHEDULER_H_
+
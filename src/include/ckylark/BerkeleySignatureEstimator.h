@@ -22,17 +22,18 @@ private:
 public:
     BerkeleySignatureEstimator(Language lang, const Dictionary & known_words);
 
-    std::string getSignature(const std::vector<std::string> & sentence, size_t location);
+    std::string getSignature(const std::vector<std::string> & sentence, size_t location) const;
+    int getLocationClass(const std::vector<std::string> & sentence, size_t location) const;
 
 private:
     Language lang_;
     const Dictionary & known_words_;
 
     // get the signature of any other latin-alphabet language's word
-    std::string getOtherSignature(const std::vector<std::string> & sentence, size_t location);
+    std::string getOtherSignature(const std::vector<std::string> & sentence, size_t location) const;
     
     // get the signature of English word
-    std::string getEnglishSignature(const std::vector<std::string> & sentence, size_t location);
+    std::string getEnglishSignature(const std::vector<std::string> & sentence, size_t location) const;
 
 }; // class BerkeleySignatureEstimator
 
@@ -0,0 +1,144 @@
+#ifndef CKYLARK_BINARY_MODEL_H_
+#define CKYLARK_BINARY_MODEL_H_
+
+#include <ckylark/MappedFile.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Ckylark {
+
+// binary model files consist of a header and a sequence of values/arrays.
+// every array is aligned from the head of the file, so the arrays are
+// directly usable on the memory mapping of the file.
+class BinaryModel {
+
+    BinaryModel() = delete;
+    BinaryModel(const BinaryModel &) = delete;
+    BinaryModel & operator=(const BinaryModel &) = delete;
+
+public:
+    // alignment of arrays in bytes
+    static const size_t ALIGNMENT = 64;
+
+    // this must be increased when the layout is changed
+    static const uint32_t VERSION = 2;
+
+    static const char MAGIC[8];
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    // check the magic number of the file
+    static bool isBinaryModel(const std::string & path);
+
+}; // class BinaryModel
+
+class BinaryModelWriter {
+
+    BinaryModelWriter() = delete;
+    BinaryModelWriter(const BinaryModelWriter &) = delete;
+    BinaryModelWriter & operator=(const BinaryModelWriter &) = delete;
+
+public:
+    explicit BinaryModelWriter(const std::string & path);
+    ~BinaryModelWriter();
+
+    template <typename T>
+    void write(const T & value) {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryModelWriter: not trivially copyable");
+        writeBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(const T * data, size_t size) {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryModelWriter: not trivially copyable");
+        write<uint64_t>(size);
+        pad();
+        writeBytes(data, size * sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T> & data) {
+        writeArray(data.data(), data.size());
+    }
+
+    void writeString(const std::string & value) {
+        writeArray(value.data(), value.size());
+    }
+
+    // flush all data and check errors
+    void close();
+
+private:
+    std::ofstream ofs_;
+    size_t pos_;
+
+    void writeBytes(const void * data, size_t size);
+    void pad();
+
+}; // class BinaryModelWriter
+
+class BinaryModelReader {
+
+    BinaryModelReader() = delete;
+    BinaryModelReader(const BinaryModelReader &) = delete;
+    BinaryModelReader & operator=(const BinaryModelReader &) = delete;
+
+public:
+    explicit BinaryModelReader(const std::shared_ptr<const MappedFile> & file);
+    ~BinaryModelReader();
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryModelReader: not trivially copyable");
+        T value;
+        std::memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // retrieve the array on the mapping
+    template <typename T>
+    const T * readArray(size_t & size) {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryModelReader: not trivially copyable");
+        uint64_t n = read<uint64_t>();
+        skipPadding();
+        if (n > (file_->size() - pos_) / sizeof(T)) {
+            throw std::runtime_error("BinaryModelReader::readArray(): unexpected end of file: " + file_->getPath());
+        }
+        size = n;
+        return static_cast<const T *>(readBytes(n * sizeof(T)));
+    }
+
+    template <typename T>
+    std::vector<T> readVector() {
+        size_t size;
+        const T * data = readArray<T>(size);
+        return std::vector<T>(data, data + size);
+    }
+
+    std::string readString() {
+        size_t size;
+        const char * data = readArray<char>(size);
+        return std::string(data, size);
+    }
+
+    // the mapping must be kept while arrays are used
+    inline const std::shared_ptr<const MappedFile> & getFile() const { return file_; }
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    size_t pos_;
+
+    const void * readBytes(size_t size);
+    void skipPadding();
+
+}; // class BinaryModelReader
+
+} // namespace Ckylark
+
+#endif // CKYLARK_BINARY_MODEL_H_
@@ -0,0 +1,44 @@
+#ifndef CKYLARK_BIT_UTIL_H_
+#define CKYLARK_BIT_UTIL_H_
+
+#include <cstdint>
+
+namespace Ckylark {
+
+// utility functions for the bitset of subtags
+// each subtag set is stored in one machine word, so at most 64 subtags are allowed.
+class BitUtil {
+
+    BitUtil() = delete;
+    BitUtil(const BitUtil &) = delete;
+    BitUtil & operator=(const BitUtil &) = delete;
+
+public:
+
+    // maximum number of bits in one mask
+    static const int MAX_BITS = 64;
+
+    // mask which has only the index-th bit
+    inline static uint64_t bit(int index) { return static_cast<uint64_t>(1) << index; }
+
+    // true if the index-th bit is set, false otherwise
+    inline static bool test(uint64_t mask, int index) { return (mask >> index) & 1; }
+
+    // index of the lowest set bit (mask must not be 0)
+    inline static int lowest(uint64_t mask) { return __builtin_ctzll(mask); }
+
+    // number of set bits
+    inline static int count(uint64_t mask) { return __builtin_popcountll(mask); }
+
+    // remove the lowest set bit
+    inline static uint64_t dropLowest(uint64_t mask) { return mask & (mask - 1); }
+
+    // mask which has bits [0, n)
+    inline static uint64_t fill(int n) { return (n >= MAX_BITS) ? ~static_cast<uint64_t>(0) : bit(n) - 1; }
+
+}; // class BitUtil
+
+} // namespace Ckylark
+
+#endif // CKYLARK_BIT_UTIL_H_
+
@@ -0,0 +1,79 @@
+#ifndef CKYLARK_BOUNDED_QUEUE_H_
+#define CKYLARK_BOUNDED_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+namespace Ckylark {
+
+// FIFO queue between pipeline stages.
+// push() blocks while the queue is full, so a fast producer waits for
+// consumers instead of buffering unbounded data.
+template <typename T>
+class BoundedQueue {
+
+    BoundedQueue() = delete;
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(capacity)
+        , closed_(false) {
+
+        if (capacity == 0) {
+            throw std::runtime_error("BoundedQueue::BoundedQueue(): invalid value: capacity");
+        }
+    }
+
+    ~BoundedQueue() {}
+
+    // wait for a free space and add the value.
+    // returns false (and drops the value) if the queue is closed.
+    bool push(T && value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&]() { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+        items_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // wait for a value and remove it.
+    // returns false if the queue is closed and all values are already removed.
+    bool pop(T & value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&]() { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        value = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // reject further push() calls, and wake up all waiting threads.
+    // remaining values can still be removed by pop().
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    bool closed_;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+
+}; // class BoundedQueue
+
+} // namespace Ckylark
+
+#endif // CKYLARK_BOUNDED_QUEUE_H_
+
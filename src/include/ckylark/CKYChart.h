@@ -0,0 +1,87 @@
+#ifndef CKYLARK_CKY_CHART_H_
+#define CKYLARK_CKY_CHART_H_
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Ckylark {
+
+// CKY chart which holds the values of all subtags.
+// values of each span are stored in one contiguous slab, and the subtags
+// of each tag are located in the slab using per-tag offsets.
+template <class T>
+class CKYChart {
+
+    CKYChart(const CKYChart &) = delete;
+    CKYChart & operator=(const CKYChart &) = delete;
+
+public:
+    CKYChart()
+        : num_words_(0)
+        , num_tags_(0)
+        , cell_size_(0) {
+    }
+
+    ~CKYChart() {}
+
+    // change the layout of the chart and fill all values.
+    // offset[tag] is the first position of the tag in each slab,
+    // and offset[num_tags] is the size of the slab.
+    // memory is reallocated only if the chart becomes larger than ever.
+    void reset(size_t num_words, const std::vector<int> & offset, const T & value) {
+        if (offset.empty())
+            throw std::runtime_error("CKYChart: empty offset list");
+        num_words_ = num_words;
+        num_tags_ = offset.size() - 1;
+        cell_size_ = offset.back();
+        offset_.assign(offset.begin(), offset.end());
+        shift_.resize(num_words_ + 1);
+        shift_[0] = 0; // dummy
+        if (num_words_ > 0) {
+            shift_[1] = 0;
+            for (size_t i = 2; i <= num_words_; ++i) {
+                shift_[i] = shift_[i - 1] + (num_words_ - i + 2);
+            }
+        }
+        mem_.assign(cell_size_ * ((num_words_ * (num_words_ + 1)) >> 1), value);
+    }
+
+    // exchange all contents
+    void swap(CKYChart & other) {
+        std::swap(num_words_, other.num_words_);
+        std::swap(num_tags_, other.num_tags_);
+        std::swap(cell_size_, other.cell_size_);
+        offset_.swap(other.offset_);
+        shift_.swap(other.shift_);
+        mem_.swap(other.mem_);
+    }
+
+    // retrieve the first subtag of the tag in the span
+    inline const T * at(size_t begin, size_t end, size_t tag) const {
+        if (begin >= num_words_ || end > num_words_ || end <= begin || tag >= num_tags_)
+            throw std::runtime_error("CKYChart: invalid index");
+        return &mem_[cell_size_ * (shift_[end - begin] + begin) + offset_[tag]];
+    }
+
+    inline T * at(size_t begin, size_t end, size_t tag) {
+        return const_cast<T *>(static_cast<const CKYChart &>(*this).at(begin, end, tag));
+    }
+
+    inline size_t numWords() const { return num_words_; }
+    inline size_t numTags() const { return num_tags_; }
+
+private:
+    size_t num_words_;
+    size_t num_tags_;
+    size_t cell_size_;
+    std::vector<int> offset_; // [tag]
+    std::vector<size_t> shift_; // [length]
+    std::vector<T> mem_;
+
+}; // class CKYChart
+
+} // namespace Ckylark
+
+#endif // CKYLARK_CKY_CHART_H_
+
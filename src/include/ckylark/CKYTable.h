@@ -8,28 +8,54 @@ namespace Ckylark {
 template <class T>
 class CKYTable {
 
-    CKYTable() = delete;
     CKYTable(const CKYTable &) = delete;
     CKYTable & operator=(const CKYTable &) = delete;
 
 public:
-    CKYTable(size_t num_words, size_t num_tags)
-        : num_words_(num_words)
-        , num_tags_(num_tags) {
+    CKYTable()
+        : num_words_(0)
+        , num_tags_(0)
+        , word_capacity_(0)
+        , capacity_(0)
+        , shift_(nullptr)
+        , mem_(nullptr) {
+    }
 
-        shift_ = new int[num_words_ + 1];
-        shift_[0] = -static_cast<int>(num_words) - 1; // dummy
-        for (size_t i = 1; i <= num_words; ++i) {
-            shift_[i] = shift_[i - 1] + (num_words - i + 2);
-        }
+    CKYTable(size_t num_words, size_t num_tags)
+        : CKYTable() {
 
-        mem_ = new T[num_tags_ * ((num_words_ * (num_words_ + 1)) >> 1)];
+        reset(num_words, num_tags);
     }
 
     ~CKYTable() {
         delete[] shift_;
         delete[] mem_;
     }
+
+    // change the size of the table. values are left undefined.
+    // memory is reallocated only if the table becomes larger than ever.
+    void reset(size_t num_words, size_t num_tags) {
+        const size_t size = num_tags * ((num_words * (num_words + 1)) >> 1);
+
+        if (!shift_ || num_words > word_capacity_) {
+            delete[] shift_;
+            shift_ = new int[num_words + 1];
+            word_capacity_ = num_words;
+        }
+        if (size > capacity_) {
+            delete[] mem_;
+            mem_ = new T[size];
+            capacity_ = size;
+        }
+
+        num_words_ = num_words;
+        num_tags_ = num_tags;
+
+        shift_[0] = -static_cast<int>(num_words) - 1; // dummy
+        for (size_t i = 1; i <= num_words; ++i) {
+            shift_[i] = shift_[i - 1] + (num_words - i + 2);
+        }
+    }
  
     inline const T & at(size_t begin, size_t end, size_t tag) const {
         if (begin >= num_words_ || end > num_words_ || end <= begin || tag >= num_tags_)
@@ -47,6 +73,8 @@ public:
 private:
     size_t num_words_;
     size_t num_tags_;
+    size_t word_capacity_;
+    size_t capacity_;
 
     int * shift_;
 
@@ -0,0 +1,50 @@
+#ifndef CKYLARK_CHECKED_SCORE_KERNEL_H_
+#define CKYLARK_CHECKED_SCORE_KERNEL_H_
+
+#include <ckylark/ScoreKernel.h>
+
+#include <memory>
+
+namespace Ckylark {
+
+// runs 2 kernels and throws if the target disagrees with the reference.
+// results of the target are used for parsing.
+class CheckedScoreKernel : public ScoreKernel {
+
+    CheckedScoreKernel(const CheckedScoreKernel &) = delete;
+    CheckedScoreKernel & operator=(const CheckedScoreKernel &) = delete;
+
+public:
+    // relative error allowed between 2 kernels
+    static constexpr double TOLERANCE = 1e-9;
+
+    CheckedScoreKernel(
+        std::shared_ptr<ScoreKernel> reference,
+        std::shared_ptr<ScoreKernel> target);
+    ~CheckedScoreKernel() {}
+
+    std::string getName() const;
+
+    double binaryInside(
+        const double * rows, int stride, uint64_t row_mask,
+        const double * left, uint64_t lmask,
+        const double * right, uint64_t rmask) const;
+
+    void binaryOutside(
+        const double * rows, int stride, uint64_t row_mask, double parent,
+        const double * left, uint64_t lmask, double * outside_left,
+        const double * right, uint64_t rmask, double * outside_right) const;
+
+    void accumulate(double * dest, double scale, const double * src, int size) const;
+
+private:
+    std::shared_ptr<ScoreKernel> reference_;
+    std::shared_ptr<ScoreKernel> target_;
+
+    void check(const std::string & func, double expected, double actual) const;
+
+}; // class CheckedScoreKernel
+
+} // namespace Ckylark
+
+#endif // CKYLARK_CHECKED_SCORE_KERNEL_H_
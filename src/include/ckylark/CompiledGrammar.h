@@ -0,0 +1,109 @@
+#ifndef CKYLARK_COMPILED_GRAMMAR_H_
+#define CKYLARK_COMPILED_GRAMMAR_H_
+
+#include <ckylark/BinaryModel.h>
+#include <ckylark/BitUtil.h>
+#include <ckylark/Grammar.h>
+#include <ckylark/MappedFile.h>
+#include <ckylark/TagSet.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Ckylark {
+
+// binary rule in CompiledGrammar
+struct CompiledBinaryRule {
+    int parent;
+    int left;
+    int right;
+    int stride; // distance between 2 rows (#right subtags, padded)
+    uint64_t parent_mask; // parent subtags which have any scores
+    size_t psub_begin; // first index of row tables
+}; // struct CompiledBinaryRule
+
+// unary rule in CompiledGrammar
+struct CompiledUnaryRule {
+    int parent;
+    int child;
+    uint64_t parent_mask; // parent subtags which have any scores
+    size_t psub_begin; // first index of row tables
+}; // struct CompiledUnaryRule
+
+// read-only form of Grammar for parsing.
+// all scores are packed into one aligned buffer:
+//   binary rule: [psub]{lsub}[rsub] (only rows which have any scores)
+//   unary rule: {psub}[csub]
+// if loaded from a binary model, scores are used on the memory mapping.
+class CompiledGrammar {
+
+    CompiledGrammar() = delete;
+    CompiledGrammar(const CompiledGrammar &) = delete;
+    CompiledGrammar & operator=(const CompiledGrammar &) = delete;
+
+public:
+    // alignment of rows in bytes
+    static const int ALIGNMENT = 32;
+
+    explicit CompiledGrammar(const Grammar & grammar);
+    ~CompiledGrammar();
+
+    static std::shared_ptr<CompiledGrammar> loadFromBinary(
+        BinaryModelReader & reader,
+        const TagSet & tag_set,
+        int level);
+
+    void saveToBinary(BinaryModelWriter & writer) const;
+
+    inline int getLevel() const { return level_; }
+
+    inline const std::vector<CompiledBinaryRule> & getBinaryRuleList(int parent) const { return binary_parent_[parent]; }
+    inline const std::vector<CompiledUnaryRule> & getUnaryRuleListByPC(int parent) const { return unary_parent_[parent]; }
+    inline const std::vector<CompiledUnaryRule> & getUnaryRuleListByCP(int child) const { return unary_child_[child]; }
+
+    // left subtags which have the row of scores
+    inline uint64_t getRowMask(const CompiledBinaryRule & rule, int psub) const {
+        return row_mask_[rule.psub_begin + psub];
+    }
+
+    // all rows of the parent subtag (psub must be in rule.parent_mask)
+    inline const double * getRows(const CompiledBinaryRule & rule, int psub) const {
+        return scores_ + row_offset_[rule.psub_begin + psub];
+    }
+
+    // scores of all right subtags (lsub must be in getRowMask())
+    inline const double * getRow(const CompiledBinaryRule & rule, int psub, int lsub) const {
+        size_t i = rule.psub_begin + psub;
+        int rank = BitUtil::count(row_mask_[i] & (BitUtil::bit(lsub) - 1));
+        return scores_ + row_offset_[i] + rank * rule.stride;
+    }
+
+    // scores of all child subtags (psub must be in rule.parent_mask)
+    inline const double * getRow(const CompiledUnaryRule & rule, int psub) const {
+        return scores_ + row_offset_[rule.psub_begin + psub];
+    }
+
+private:
+    int level_;
+    std::vector<std::vector<CompiledBinaryRule> > binary_parent_; // [parent]{(left, right)}
+    std::vector<std::vector<CompiledUnaryRule> > unary_parent_; // [parent]{child}
+    std::vector<std::vector<CompiledUnaryRule> > unary_child_; // [child]{parent}
+    std::vector<uint64_t> row_mask_; // [psub_begin + psub]
+    std::vector<size_t> row_offset_; // [psub_begin + psub]
+    std::vector<double> buffer_;
+    const double * scores_; // aligned head of buffer_, or the mapping
+    size_t size_; // number of scores
+    std::shared_ptr<const MappedFile> file_; // keeps the mapping
+
+    explicit CompiledGrammar(int level);
+
+    // allocate zero-filled aligned scores in buffer_
+    double * allocateScores(size_t size);
+
+}; // class CompiledGrammar
+
+} // namespace Ckylark
+
+#endif // CKYLARK_COMPILED_GRAMMAR_H_
+
@@ -1,12 +1,15 @@
 #ifndef CKYLARK_DICTIONARY_H_
 #define CKYLARK_DICTIONARY_H_
 
-#include <map>
+#include <ckylark/StringUtil.h>
+
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace Ckylark {
 
+// word <-> ID table using an open-addressing hash table
 class Dictionary {
 
     Dictionary(const Dictionary &) = delete;
@@ -18,20 +21,26 @@ public:
 
     void addWord(const std::string & word);
 
-    int getId(const std::string & word) const;
+    inline int getId(const std::string & word) const { return find(word.data(), word.size()); }
+    // same as getId(piece.str()), without copying the string
+    inline int getId(const StringPiece & piece) const { return find(piece.begin, piece.size()); }
     std::string getWord(int id) const;
 
-    inline size_t size() const { return ids_.size(); }
+    inline size_t size() const { return rev_.size(); }
 
     inline const std::vector<std::string> & getWordList() const { return rev_; }
 
 private:
-    std::map<std::string, int> ids_;
-    std::vector<std::string> rev_;
+    std::vector<int> slot_; // [hash & mask] = ID, or -1 if empty
+    std::vector<uint32_t> hash_; // [ID]
+    std::vector<std::string> rev_; // [ID]
+
+    static uint32_t calculateHash(const char * str, size_t len);
+    int find(const char * str, size_t len) const;
+    void rehash(size_t num_slots);
 
 }; // class Dictionary
 
 } // namespace Ckylark
 
 #endif // CKYLARK_DICTIONARY_H_
-
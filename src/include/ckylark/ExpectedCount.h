@@ -0,0 +1,43 @@
+#ifndef CKYLARK_EXPECTED_COUNT_H_
+#define CKYLARK_EXPECTED_COUNT_H_
+
+#include <ckylark/TagSet.h>
+#include <ckylark/Grammar.h>
+
+#include <vector>
+
+namespace Ckylark {
+
+// expected number of occurrences of each subtag in a tree generated from ROOT.
+// counts are solved by the fixed-point iteration
+//   c(Y) = [Y == ROOT] + sum_X[ c(X) T(X -> Y) ]
+// over the sparse transition matrix T of the grammar, until they converge.
+class ExpectedCount {
+
+    ExpectedCount() = delete;
+    ExpectedCount(const ExpectedCount &) = delete;
+    ExpectedCount & operator=(const ExpectedCount &) = delete;
+
+public:
+    ExpectedCount(const TagSet & tag_set, const Grammar & grammar);
+    ~ExpectedCount();
+
+    inline int getLevel() const { return level_; }
+    inline int numIterations() const { return num_iterations_; }
+
+    inline double getCount(int tag, int subtag) const {
+        return count_[offset_[tag] + subtag];
+    }
+
+private:
+    int level_;
+    int num_iterations_;
+    std::vector<int> offset_; // [tag] = position of subtag 0
+    std::vector<double> count_; // [position]
+
+}; // class ExpectedCount
+
+} // namespace Ckylark
+
+#endif // CKYLARK_EXPECTED_COUNT_H_
+
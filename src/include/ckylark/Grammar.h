@@ -6,8 +6,10 @@
 #include <ckylark/Rule.h>
 #include <ckylark/Stream.h>
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace Ckylark {
@@ -28,6 +30,7 @@ public:
 
     const TagSet & getTagSet() const { return tag_set_; }
 
+    // retrieve the rule, or create it if not exist
     BinaryRule & getBinaryRule(int parent, int left, int right);
     UnaryRule & getUnaryRule(int parent, int child);
 
@@ -48,6 +51,14 @@ private:
     //std::vector<std::vector<std::vector<BinaryRule *> > > binary_left_right_; // [left][right]{parent}
     std::vector<std::vector<UnaryRule *> > unary_parent_; // [parent]{child}
     std::vector<std::vector<UnaryRule *> > unary_child_; // [child]{parent}
+    std::unordered_map<uint64_t, BinaryRule *> binary_index_; // {(parent, left, right)}
+    std::unordered_map<uint64_t, UnaryRule *> unary_index_; // {(parent, child)}
+
+    // key of binary_index_ and unary_index_
+    inline uint64_t makeKey(int a, int b, int c = 0) const {
+        const uint64_t n = binary_parent_.size();
+        return (static_cast<uint64_t>(a) * n + b) * n + c;
+    }
 
 }; // class Grammar
 
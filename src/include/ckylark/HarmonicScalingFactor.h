@@ -2,6 +2,7 @@
 
 #include <ckylark/ScalingFactor.h>
 #include <ckylark/Dictionary.h>
+#include <ckylark/ExpectedCount.h>
 #include <ckylark/TagSet.h>
 #include <ckylark/Lexicon.h>
 #include <ckylark/Grammar.h>
@@ -21,6 +22,7 @@ public:
         const TagSet & tag_set,
         const Lexicon & lexicon,
         const Grammar & grammar,
+        const ExpectedCount & expected_count,
         double lexicon_smoothing_factor);
     ~HarmonicScalingFactor() {}
     
@@ -3,29 +3,44 @@
 
 #include <ckylark/Parser.h>
 
+#include <ckylark/CKYChart.h>
 #include <ckylark/CKYTable.h>
+#include <ckylark/CompiledGrammar.h>
+#include <ckylark/ScoreKernel.h>
 #include <ckylark/Dictionary.h>
+#include <ckylark/ExpectedCount.h>
 #include <ckylark/TagSet.h>
 #include <ckylark/Lexicon.h>
 #include <ckylark/Grammar.h>
 #include <ckylark/M1Lexicon.h>
 #include <ckylark/M1Grammar.h>
+#include <ckylark/Mapping.h>
+#include <ckylark/OOVLexicon.h>
+#include <ckylark/OOVLexiconSmoother.h>
+#include <ckylark/ParseWorkspace.h>
 #include <ckylark/Tree.h>
 #include <ckylark/ScalingFactor.h>
 #include <ckylark/SignatureEstimator.h>
+#include <ckylark/TaskGroup.h>
+#include <ckylark/TerminalScoreTable.h>
+#include <ckylark/ThreadPool.h>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 
 namespace Ckylark {
 
+// concurrency:
+//   the model is immutable after loading, except components generated on the first
+//   use, which are built only once under std::call_once. so parse() can be called
+//   from any number of threads at the same time. all mutable states of a parse are
+//   held in ParseWorkspace, which is given by the caller or owned by each thread.
+//   set*() methods must not be called while other threads are parsing.
 class LAPCFGParser : public Parser {
 
-    struct Extent {
-        int narrow_right;
-        int narrow_left;
-        int wide_right;
-        int wide_left;
-    }; // struct Extent
+    typedef ParseWorkspace::Extent Extent;
 
     LAPCFGParser();
     LAPCFGParser(const LAPCFGParser &) = delete;
@@ -39,15 +54,41 @@ public:
         double smooth_unklex,
         const std::string & scaling);
 
+    // smooth_unklex and scaling must be same as the compiled model
+    static std::shared_ptr<LAPCFGParser> loadFromBinary(
+        const std::string & path,
+        double smooth_unklex,
+        const std::string & scaling);
+
+    // write all levels, the G-1 model and scaling factors
+    void saveToBinary(const std::string & path) const;
+
+    // uses the workspace owned by the calling thread (thread-safe)
     virtual ParserResult parse(
         const std::vector<std::string> & sentence,
         const ParserSetting & setting) const;
 
+    // the workspace must not be used by other parses at the same time
+    ParserResult parse(
+        const std::vector<std::string> & sentence,
+        const ParserSetting & setting,
+        ParseWorkspace & workspace) const;
+
+    // each thread of the batch uses its own workspace, which is kept by the parser
+    // for later batches, so signature caches and buffers survive across batches.
+    virtual std::vector<ParserResult> parseBatch(
+        const std::vector<std::vector<std::string> > & sentences,
+        const ParserSetting & setting,
+        const ParserBatchOptions & options) const;
+
     const Dictionary & getWordTable() const { return *word_table_; }
     const TagSet & getTagSet() const { return *tag_set_; }
     const Lexicon & getLexicon(int level) const { return *(lexicon_[level]); }
-    const Grammar & getGrammar(int level) const { return *(grammar_[level]); }
-    const ScalingFactor & getScalingFactor(int level) const { return *(scaling_factor_[level]); }
+    // grammars are not held if loaded from a binary model
+    const Grammar & getGrammar(int level) const;
+    // below components are generated on the first use
+    const CompiledGrammar & getCompiledGrammar(int level) const;
+    const ScalingFactor & getScalingFactor(int level) const;
 
     int getFineLevel() const { return fine_level_; }
     void setFineLevel(int value);
@@ -57,66 +98,118 @@ public:
 
     double getUNKLexiconSmoothing() const { return smooth_unklex_; }
 
+    const std::string & getScaling() const { return scaling_; }
+
     bool getDoM1Preparse() const { return do_m1_preparse_; }
-    void setDoM1Preparse(bool value) { do_m1_preparse_ = value; }
+    void setDoM1Preparse(bool value) { do_m1_preparse_ = value; model_ready_ = false; }
 
     bool getForceGenerate() const { return force_generate_; }
     void setForceGenerate(bool value) { force_generate_ = value; }
 
+    const ScoreKernel & getScoreKernel() const { return *score_kernel_; }
+    void setScoreKernel(std::shared_ptr<ScoreKernel> value);
+
+    // number of threads to parse each sentence, or 0 (use all hardware threads).
+    // cells of the same span length are processed in parallel, and results do not
+    // depend on this value.
+    int getNumSpanThreads() const { return span_pool_ ? span_pool_->numThreads() : 1; }
+    void setNumSpanThreads(int value);
+
 private:
+    const uint64_t serial_; // unique in the process
     std::shared_ptr<Dictionary> word_table_;
     std::shared_ptr<TagSet> tag_set_;
     std::vector<std::shared_ptr<Lexicon> > lexicon_;
     std::vector<std::shared_ptr<Grammar> > grammar_;
-    std::vector<std::shared_ptr<ScalingFactor> > scaling_factor_;
-    std::shared_ptr<M1Lexicon> m1_lexicon_;
-    std::shared_ptr<M1Grammar> m1_grammar_;
-    std::shared_ptr<SignatureEstimator> sig_est_;
+    std::shared_ptr<ScoreKernel> score_kernel_;
+    std::vector<std::shared_ptr<Mapping> > mapping_; // [level]: (level - 1) -> level
+
+    // generated by prepareLevel(level), only for levels used by parse()
+    mutable std::atomic<bool> model_ready_; // true if prepareModel() has nothing to do
+    mutable std::unique_ptr<std::once_flag[]> level_once_; // [level]
+    mutable std::vector<std::shared_ptr<CompiledGrammar> > compiled_grammar_;
+    mutable std::vector<std::shared_ptr<ScalingFactor> > scaling_factor_;
+    mutable std::vector<std::shared_ptr<TerminalScoreTable> > terminal_score_;
+    mutable std::vector<std::shared_ptr<ExpectedCount> > expected_count_; // [level] (released after use, or if not used)
+
+    // generated by prepareM1Model(), only if G-1 pre-parsing is used
+    mutable std::once_flag m1_once_;
+    mutable std::shared_ptr<M1Lexicon> m1_lexicon_;
+    mutable std::shared_ptr<M1Grammar> m1_grammar_;
+    mutable std::shared_ptr<M1OOVLexiconSmoother> m1_smoother_;
+    std::shared_ptr<const SignatureEstimator> sig_est_;
 
     int fine_level_;
     double prune_threshold_;
     double smooth_unklex_;
+    std::string scaling_;
     bool do_m1_preparse_;
     bool force_generate_;
+    std::shared_ptr<ThreadPool> span_pool_; // nullptr if spans are processed serially
+
+    // workspaces not used by running parseBatch() calls
+    mutable std::mutex workspace_mutex_;
+    mutable std::vector<std::unique_ptr<ParseWorkspace> > spare_workspace_;
 
     ParserResult generateMaxRuleOneBestParse(
         const std::vector<std::string> & sentence,
         const ParserSetting & setting,
-        int final_level_to_try) const;
+        int final_level_to_try,
+        ParseWorkspace & workspace) const;
 
     void loadWordTable(const std::string & path);
     void loadTagSet(const std::string & path);
+    void checkTagSet() const;
     void loadLexicon(const std::string & path);
     void loadGrammar(const std::string & path);
     void generateCoarseModels();
-    void generateScalingFactors(const std::string & name);
+
+    // expected counts of each level are solved only once after all levels are generated
+    // (concurrent callers must request different levels)
+    const ExpectedCount & getExpectedCount(int level) const;
+
+    // generate missing components of the level or G-1 only once (thread-safe)
+    void prepareModel() const;
+    void prepareLevel(int level) const;
+    void prepareM1Model() const;
+    std::shared_ptr<ScalingFactor> generateScalingFactor(int level) const;
+
+    void generateMappings();
+    void finishLoading();
     
     void setUNKLexiconSmoothing(double value);
     
     std::shared_ptr<Tree<std::string> > getDefaultParse(const std::vector<std::string> & sentence) const;
 
-    std::vector<int> makeWordIdList(const std::vector<std::string> & sentence) const;
+    // results are stored into workspace.wid_list_
+    void makeWordIdList(
+        const std::vector<std::string> & sentence,
+        ParseWorkspace & workspace) const;
 
-    std::vector<int> makeTagIdList(const std::vector<std::string> & sentence) const;
+    void makeTagIdList(
+        const std::vector<std::string> & sentence,
+        std::vector<int> & tid_list) const;
 
     void doM1Preparse(
         CKYTable<bool> & allowed_tag,
         const std::vector<int> & wid_list,
         const std::vector<int> & tid_list,
+        CKYTable<double> & inside,
+        CKYTable<double> & outside,
         bool partial) const;
 
     void initializeCharts(
         CKYTable<bool> & allowed_tag,
-        CKYTable<std::vector<bool> > & allowed_sub,
-        CKYTable<std::vector<double> > & inside,
-        CKYTable<std::vector<double> > & outside,
+        CKYTable<uint64_t> & allowed_sub,
+        CKYChart<double> & inside,
+        CKYChart<double> & outside,
         std::vector<std::vector<Extent> > & extent,
         int cur_level) const;
 
     void setTerminalScores(
         const CKYTable<bool> & allowed_tag,
-        const CKYTable<std::vector<bool> > & allowed_sub,
-        CKYTable<std::vector<double> > & inside,
+        const CKYTable<uint64_t> & allowed_sub,
+        CKYChart<double> & inside,
         const std::vector<int> & wid_list,
         const std::vector<int> & tid_list,
         int cur_level,
@@ -124,24 +217,33 @@ private:
 
     void calculateInsideScores(
         const CKYTable<bool> & allowed_tag,
-        const CKYTable<std::vector<bool> > & allowed_sub,
-        CKYTable<std::vector<double> > & inside,
+        const CKYTable<uint64_t> & allowed_sub,
+        CKYChart<double> & inside,
         std::vector<std::vector<Extent> > & extent,
+        std::vector<std::vector<double> > & delta_unary,
         int cur_level) const;
 
     void calculateOutsideScores(
         const CKYTable<bool> & allowed_tag,
-        const CKYTable<std::vector<bool> > & allowed_sub,
-        const CKYTable<std::vector<double> > & inside,
-        CKYTable<std::vector<double> > & outside,
+        const CKYTable<uint64_t> & allowed_sub,
+        const CKYChart<double> & inside,
+        CKYChart<double> & outside,
+        CKYChart<double> & outside_right,
         std::vector<std::vector<Extent> > & extent,
+        std::vector<std::vector<double> > & delta_unary,
         int cur_level) const;
 
+    // call func(begin, slot) for each span of the same length (num_spans = number of begins).
+    // slot selects per-thread buffers, in [0, getNumSpanThreads()).
+    // func is taken as is, so that calling it does not allocate memory.
+    template <typename Func>
+    void forEachSpan(int num_spans, const Func & func) const;
+
     void pruneCharts(
         CKYTable<bool> & allowed_tag,
-        CKYTable<std::vector<bool> > & allowed_sub,
-        const CKYTable<std::vector<double> > & inside,
-        const CKYTable<std::vector<double> > & outside,
+        CKYTable<uint64_t> & allowed_sub,
+        const CKYChart<double> & inside,
+        const CKYChart<double> & outside,
         int cur_level) const;
 
 }; // struct Model
@@ -1,6 +1,7 @@
 #ifndef CKYLARK_LEXICON_H_
 #define CKYLARK_LEXICON_H_
 
+#include <ckylark/BinaryModel.h>
 #include <ckylark/TagSet.h>
 #include <ckylark/Dictionary.h>
 #include <ckylark/Stream.h>
@@ -56,10 +57,29 @@ public:
         const Dictionary & word_table,
         const TagSet & tag_set);
 
+    static std::shared_ptr<Lexicon> loadFromBinary(
+        BinaryModelReader & reader,
+        const TagSet & tag_set,
+        int level);
+
+    void saveToBinary(BinaryModelWriter & writer) const;
+
     const LexiconEntry * getEntry(int tag_id, int word_id) const;
     LexiconEntry & getEntryOrCreate(int tag_id, int word_id);
 
-    const std::vector<std::map<int, LexiconEntry *> > getEntryList() const { return entry_; }
+    const std::vector<std::map<int, LexiconEntry *> > & getEntryList() const { return entry_; }
+
+    // entries of the word sorted by tag, in the range [begin, end)
+    inline const LexiconEntry * const * getWordEntryBegin(int word_id) const {
+        return word_entry_.data() + word_offset_[getWordSlot(word_id)];
+    }
+    inline const LexiconEntry * const * getWordEntryEnd(int word_id) const {
+        return word_entry_.data() + word_offset_[getWordSlot(word_id) + 1];
+    }
+
+    // make the word-indexed view of entries
+    // (called by loaders, and must be called again after adding entries)
+    void makeWordIndex();
 
     inline const TagSet & getTagSet() const { return tag_set_; }
     inline int getLevel() const { return level_; }
@@ -70,6 +90,14 @@ private:
     const TagSet & tag_set_;
     int level_;
     std::vector<std::map<int, LexiconEntry *> > entry_; // [category]{word}
+    std::vector<int> word_offset_; // [word] = first index of word_entry_, [num_words] = end
+    std::vector<const LexiconEntry *> word_entry_; // {entry} grouped by word
+
+    // unknown words share the last empty slot
+    inline int getWordSlot(int word_id) const {
+        const int num_words = static_cast<int>(word_offset_.size()) - 2;
+        return (word_id >= 0 && word_id < num_words) ? word_id : num_words;
+    }
 
 }; // class Lexicon
 
@@ -48,7 +48,7 @@ public:
     virtual ~M1LexiconSmoother() {}
 
     // retrieve the score of specific tag.
-    virtual double getScore(int tag_id, int word_id) = 0;
+    virtual double getScore(int tag_id, int word_id) const = 0;
 
     // retrieve the target lexicon.
     inline const M1Lexicon & getLexicon() const { return lexicon_; }
@@ -1,8 +1,10 @@
 #ifndef CKYLARK_M1_GRAMMAR_H_
 #define CKYLARK_M1_GRAMMAR_H_
 
+#include <ckylark/BinaryModel.h>
 #include <ckylark/TagSet.h>
 
+#include <memory>
 #include <vector>
 
 namespace Ckylark {
@@ -21,11 +23,41 @@ class M1Grammar {
     M1Grammar & operator=(const M1Grammar &) = delete;
 
 public:
+    struct BinaryEntry {
+        int right;
+        double score;
+    }; // struct BinaryEntry
+
     M1Grammar(const TagSet & tag_set)
         : binary_(tag_set.numTags(), std::vector<double>(tag_set.numTags(), 0.0))
-        , unary_(tag_set.numTags(), 0.0) {}
+        , unary_(tag_set.numTags(), 0.0)
+        , binary_entry_(tag_set.numTags()) {}
     ~M1Grammar() {}
 
+    static std::shared_ptr<M1Grammar> loadFromBinary(BinaryModelReader & reader, const TagSet & tag_set) {
+        std::shared_ptr<M1Grammar> grammar(new M1Grammar(tag_set));
+        for (auto & binary_l : grammar->binary_) {
+            binary_l = reader.readVector<double>();
+        }
+        grammar->unary_ = reader.readVector<double>();
+        for (auto & binary_l : grammar->binary_) {
+            if (binary_l.size() != tag_set.numTags())
+                throw std::runtime_error("M1Grammar::loadFromBinary(): number of tags mismatched");
+        }
+        if (grammar->unary_.size() != tag_set.numTags())
+            throw std::runtime_error("M1Grammar::loadFromBinary(): number of tags mismatched");
+        grammar->makeIndex();
+        return grammar;
+    }
+
+    void saveToBinary(BinaryModelWriter & writer) const {
+        // [left][right], [child]
+        for (auto & binary_l : binary_) {
+            writer.writeArray(binary_l);
+        }
+        writer.writeArray(unary_);
+    }
+
     inline double getBinaryScore(int left, int right) const {
         return binary_[left][right];
     }
@@ -38,13 +70,34 @@ public:
         return unary_[child];
     }
 
+    // nonzero binary scores with the left tag, sorted by the right tag
+    // (available after makeIndex())
+    inline const std::vector<BinaryEntry> & getBinaryEntryList(int left) const {
+        return binary_entry_[left];
+    }
+
     inline void addUnaryScore(int child, double delta) {
         unary_[child] += delta;
     }
 
+    // make the index of nonzero binary scores
+    // (must be called again after changing scores)
+    void makeIndex() {
+        for (size_t left = 0; left < binary_.size(); ++left) {
+            auto & entries = binary_entry_[left];
+            entries.clear();
+            for (size_t right = 0; right < binary_[left].size(); ++right) {
+                if (binary_[left][right] != 0.0) {
+                    entries.push_back(BinaryEntry { static_cast<int>(right), binary_[left][right] });
+                }
+            }
+        }
+    }
+
 private:
-    std::vector<std::vector<double> > binary_;
-    std::vector<double> unary_;
+    std::vector<std::vector<double> > binary_; // [left][right]
+    std::vector<double> unary_; // [child]
+    std::vector<std::vector<BinaryEntry> > binary_entry_; // [left]{nonzero entry}
 
 }; // class M1Grammar
 
@@ -1,13 +1,17 @@
 #ifndef CKYLARK_M1_LEXICON_H_
 #define CKYLARK_M1_LEXICON_H_
 
+#include <ckylark/BinaryModel.h>
 #include <ckylark/Dictionary.h>
 #include <ckylark/TagSet.h>
 
+#include <memory>
 #include <vector>
 
 namespace Ckylark {
 
+// G-1 lexicon
+// only nonzero scores are stored as (tag, score) lists of each word.
 class M1Lexicon {
 
     M1Lexicon() = delete;
@@ -15,29 +19,52 @@ class M1Lexicon {
     M1Lexicon & operator=(const M1Lexicon &) = delete;
 
 public:
-    M1Lexicon(const Dictionary & word_table, const TagSet & tag_set);
+    struct Entry {
+        int tag_id;
+        double score;
+    }; // struct Entry
+
+    // entries: [word]{entry}, sorted by tag_id in each word
+    M1Lexicon(const TagSet & tag_set, const std::vector<std::vector<Entry> > & entries);
     ~M1Lexicon() {}
 
+    static std::shared_ptr<M1Lexicon> loadFromBinary(
+        BinaryModelReader & reader,
+        const Dictionary & word_table,
+        const TagSet & tag_set);
+
+    void saveToBinary(BinaryModelWriter & writer) const;
+
     inline double getScore(int tag_id, int word_id) const {
-        return score_[tag_id][word_id];
+        if (word_id == -1) return 0.0;
+        for (int i = offset_[word_id]; i < offset_[word_id + 1]; ++i) {
+            if (tag_[i] == tag_id) return score_[i];
+        }
+        return 0.0;
     }
-    
-    inline void addScore(int tag_id, int word_id, double delta) {
-        score_[tag_id][word_id] += delta;
+
+    // 1 / (max_X P(X -> w)), or 1 if the word has no scores
+    inline double getScalingFactor(int word_id) const {
+        return (word_id != -1) ? scaling_[word_id] : 1.0;
     }
 
-    double getScalingFactor(int word_id) const;
+    inline size_t numWords() const { return scaling_.size(); }
 
     const TagSet & getTagSet() const { return tag_set_; }
 
 private:
+    M1Lexicon(const TagSet & tag_set);
+
+    void calculateScalingFactors();
+
     const TagSet & tag_set_;
-    std::vector<std::vector<double> > score_;
-    mutable std::vector<double> scaling_;
+    std::vector<int> offset_; // [word] = first entry, [num_words] = end
+    std::vector<int> tag_; // [entry]
+    std::vector<double> score_; // [entry]
+    std::vector<double> scaling_; // [word]
 
 }; // class M1Lexicon
 
 } // namespace Ckylark
 
 #endif // CKYLARK_M1_LEXICON_H_
-
@@ -0,0 +1,34 @@
+#ifndef CKYLARK_MAPPED_FILE_H_
+#define CKYLARK_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace Ckylark {
+
+// read-only memory mapping of a whole file.
+// pages are shared with all other processes mapping the same file.
+class MappedFile {
+
+    MappedFile() = delete;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+public:
+    explicit MappedFile(const std::string & path);
+    ~MappedFile();
+
+    inline const char * data() const { return data_; }
+    inline size_t size() const { return size_; }
+    inline const std::string & getPath() const { return path_; }
+
+private:
+    std::string path_;
+    const char * data_;
+    size_t size_;
+
+}; // class MappedFile
+
+} // namespace Ckylark
+
+#endif // CKYLARK_MAPPED_FILE_H_
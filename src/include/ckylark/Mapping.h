@@ -3,6 +3,7 @@
 
 #include <ckylark/TagSet.h>
 
+#include <cstdint>
 #include <vector>
 
 namespace Ckylark {
@@ -26,8 +27,17 @@ public:
     inline int getFineToCoarseMap(int tag, int fine_subtag) const {
         return f2c_map_[tag][fine_subtag];
     }
-    inline const std::vector<int> & getCoarseToFineMaps(int tag, int coarse_subtag) const {
-        return c2f_map_[tag][coarse_subtag];
+    // fine subtags of the coarse subtag are in the range [begin, end)
+    inline const int * getCoarseToFineBegin(int tag, int coarse_subtag) const {
+        return c2f_index_.data() + c2f_offset_[coarse_map_[tag][coarse_subtag]];
+    }
+    inline const int * getCoarseToFineEnd(int tag, int coarse_subtag) const {
+        return c2f_index_.data() + c2f_offset_[coarse_map_[tag][coarse_subtag] + 1];
+    }
+
+    // bitset of fine subtags of the coarse subtag (fine level must have at most 64 subtags)
+    inline uint64_t getCoarseToFineMask(int tag, int coarse_subtag) const {
+        return c2f_mask_[coarse_map_[tag][coarse_subtag]];
     }
 
     inline size_t getNumCoarsePos() const { return nmap_coarse_; }
@@ -42,7 +52,9 @@ private:
     std::vector<std::vector<int> > coarse_map_; // [cat_coarse][subcat_coarse] = coarse_pos
     std::vector<std::vector<int> > fine_map_; // [cat_fine][subcat_fine] = fine_pos
     std::vector<std::vector<int> > f2c_map_; // [cat_fine][subcat_fine] = subcat_coarse
-    std::vector<std::vector<std::vector<int> > > c2f_map_; // [cat_coarse][subcat_coarse] = [subcat_fine]
+    std::vector<int> c2f_offset_; // [coarse_pos] = first index of c2f_index_, [nmap_coarse_] = end
+    std::vector<int> c2f_index_; // {subcat_fine} grouped by coarse_pos
+    std::vector<uint64_t> c2f_mask_; // [coarse_pos] = bitset of subcat_fine
 
 }; // class Mapping
 
@@ -2,6 +2,7 @@
 #define CKYLARK_MODEL_PROJECTOR_H_
 
 #include <ckylark/TagSet.h>
+#include <ckylark/ExpectedCount.h>
 #include <ckylark/Grammar.h>
 #include <ckylark/Lexicon.h>
 #include <ckylark/Mapping.h>
@@ -22,6 +23,7 @@ public:
         const TagSet & tag_set,
         const Lexicon & lexicon,
         const Grammar & grammar,
+        const ExpectedCount & expected_count,
         int fine_level,
         int coarse_level);
 
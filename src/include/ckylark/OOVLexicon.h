@@ -0,0 +1,40 @@
+#ifndef CKYLARK_OOV_LEXICON_H_
+#define CKYLARK_OOV_LEXICON_H_
+
+#include <ckylark/Lexicon.h>
+#include <ckylark/Dictionary.h>
+
+#include <vector>
+
+namespace Ckylark {
+
+// sum of all UNK* lexicon entries for each tag
+// this is independent of sentences, and is shared by all parses.
+class OOVLexicon {
+
+    OOVLexicon() = delete;
+    OOVLexicon(const OOVLexicon &) = delete;
+    OOVLexicon & operator=(const OOVLexicon &) = delete;
+
+public:
+    OOVLexicon(const Lexicon & lexicon, const Dictionary & word_table);
+    ~OOVLexicon();
+
+    inline const LexiconEntry & getEntry(int tag_id) const { return *entry_[tag_id]; }
+
+    // tags which have nonzero OOV scores, sorted
+    inline const std::vector<int> & getTagList() const { return tag_list_; }
+
+    inline const Lexicon & getLexicon() const { return lexicon_; }
+
+private:
+    const Lexicon & lexicon_;
+    std::vector<LexiconEntry *> entry_; // [tag]
+    std::vector<int> tag_list_; // {tag}
+
+}; // class OOVLexicon
+
+} // namespace Ckylark
+
+#endif // CKYLARK_OOV_LEXICON_H_
+
@@ -4,6 +4,9 @@
 #include <ckylark/LexiconSmoother.h>
 
 #include <ckylark/Dictionary.h>
+#include <ckylark/OOVLexicon.h>
+
+#include <memory>
 
 namespace Ckylark {
 
@@ -19,6 +22,10 @@ public:
         const Lexicon & lexicon,
         const Dictionary & word_table,
         double ratio);
+    // use precomputed OOV entries instead of summing UNK* entries again
+    OOVLexiconSmoother(
+        const OOVLexicon & oov_lexicon,
+        double ratio);
     ~OOVLexiconSmoother();
 
     bool prepare(int tag_id, int word_id);
@@ -26,7 +33,8 @@ public:
 
 private:
     double ratio_;
-    std::vector<LexiconEntry *> oov_entries_;
+    std::shared_ptr<OOVLexicon> own_oov_lexicon_;
+    const OOVLexicon & oov_lexicon_;
 
     const LexiconEntry * cur_ent_;
     int cur_tag_;
@@ -47,7 +55,7 @@ public:
         double ratio);
     ~M1OOVLexiconSmoother();
 
-    double getScore(int tag_id, int word_id);
+    double getScore(int tag_id, int word_id) const;
 
 private:
     double ratio_;
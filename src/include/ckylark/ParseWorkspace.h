@@ -0,0 +1,72 @@
+#ifndef CKYLARK_PARSE_WORKSPACE_H_
+#define CKYLARK_PARSE_WORKSPACE_H_
+
+#include <ckylark/CKYChart.h>
+#include <ckylark/CKYTable.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Ckylark {
+
+// working buffers used by LAPCFGParser to parse 1 sentence.
+// buffers keep the size of the longest sentence ever parsed, so parsing
+// does not allocate them again in steady state.
+// a workspace must not be used by more than 1 parse at the same time.
+// (per-thread buffers of span threads are selected by the slot of ThreadPool)
+class ParseWorkspace {
+
+    ParseWorkspace(const ParseWorkspace &) = delete;
+    ParseWorkspace & operator=(const ParseWorkspace &) = delete;
+
+    friend class LAPCFGParser;
+
+public:
+    ParseWorkspace() : signature_owner_(0) {}
+    ~ParseWorkspace() {}
+
+private:
+    struct Extent {
+        int narrow_right;
+        int narrow_left;
+        int wide_right;
+        int wide_left;
+    }; // struct Extent
+
+    std::vector<int> wid_list_; // [position]
+
+    // word IDs of OOV signatures: [location class]{surface word}
+    // (valid only for the parser whose serial number is signature_owner_)
+    uint64_t signature_owner_;
+    std::vector<std::unordered_map<std::string, int> > signature_cache_;
+    std::vector<int> tid_list_; // [position]
+
+    CKYTable<bool> allowed_tag_;
+    CKYTable<uint64_t> allowed_sub_;
+    CKYChart<double> inside_;
+    CKYChart<double> outside_;
+    CKYChart<double> outside_right_; // outside scores received as a right child
+    std::vector<std::vector<Extent> > extent_; // [position][tag]
+    std::vector<std::vector<double> > delta_unary_; // [slot][subtag offset]
+
+    // G-1 pre-parsing
+    CKYTable<double> m1_inside_;
+    CKYTable<double> m1_outside_;
+
+    // max-rule parsing
+    CKYTable<double> maxc_log_score_;
+    CKYTable<int> maxc_left_;
+    CKYTable<int> maxc_right_;
+    CKYTable<int> maxc_mid_;
+    CKYTable<int> maxc_child_;
+    std::vector<std::vector<double> > after_unary_; // [slot][tag]
+    std::vector<std::vector<double> > marginal_; // [slot][lsub * stride + rsub] (with alignment margin)
+
+}; // class ParseWorkspace
+
+} // namespace Ckylark
+
+#endif // CKYLARK_PARSE_WORKSPACE_H_
+
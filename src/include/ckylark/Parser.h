@@ -1,9 +1,12 @@
 #ifndef CKYLARK_PARSER_H_
 #define CKYLARK_PARSER_H_
 
+#include <ckylark/BatchScheduler.h>
+#include <ckylark/ParserBatchOptions.h>
 #include <ckylark/ParserResult.h>
 #include <ckylark/ParserSetting.h>
 
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -20,13 +23,30 @@ public:
     virtual ~Parser() {}
 
     // generate best 1-parse
+    // implementations must allow concurrent calls from multiple threads.
     virtual ParserResult parse(
         const std::vector<std::string> & sentence,
         const ParserSetting & setting) const = 0;
 
+    // generate best 1-parse of each sentence, in the order of sentences.
+    // sentences are parsed concurrently, longest first.
+    // default implementation calls parse() for each sentence.
+    virtual std::vector<ParserResult> parseBatch(
+        const std::vector<std::vector<std::string> > & sentences,
+        const ParserSetting & setting,
+        const ParserBatchOptions & options) const;
+
+protected:
+    // call parse_one(index, thread) for each sentence on the scheduler, and collect results.
+    // also fills options.parse_times if given.
+    static std::vector<ParserResult> runBatch(
+        const std::vector<std::vector<std::string> > & sentences,
+        const ParserBatchOptions & options,
+        BatchScheduler & scheduler,
+        const std::function<ParserResult(size_t, int)> & parse_one);
+
 }; // class Parser
 
 } // namespace Ckylark
 
 #endif // CKYLARK_PARSER_H_
-
@@ -0,0 +1,34 @@
+#ifndef CKYLARK_PARSER_BATCH_OPTIONS_H_
+#define CKYLARK_PARSER_BATCH_OPTIONS_H_
+
+#include <vector>
+
+namespace Ckylark {
+
+class BatchScheduler;
+
+// configuration parameters for Parser::parseBatch()
+struct ParserBatchOptions {
+
+    ParserBatchOptions()
+        : num_threads(0)
+        , scheduler(nullptr)
+        , parse_times(nullptr) {}
+
+    // number of threads, or 0 (use all hardware threads).
+    // ignored if scheduler is given.
+    int num_threads;
+
+    // if not nullptr, sentences are parsed by this scheduler instead of a temporary one,
+    // so its threads statistics are accumulated over batches.
+    // the scheduler may be shared by concurrent parseBatch() calls.
+    BatchScheduler * scheduler;
+
+    // if not nullptr, receives the parsing time of each sentence in seconds.
+    std::vector<double> * parse_times;
+
+}; // struct ParserBatchOptions
+
+} // namespace Ckylark
+
+#endif // CKYLARK_PARSER_BATCH_OPTIONS_H_
@@ -0,0 +1,37 @@
+#ifndef CKYLARK_PRECOMPUTED_SCALING_FACTOR_H_
+#define CKYLARK_PRECOMPUTED_SCALING_FACTOR_H_
+
+#include <ckylark/ScalingFactor.h>
+
+#include <vector>
+
+namespace Ckylark {
+
+// scaling factors calculated by other strategies and restored from binary models
+class PrecomputedScalingFactor : public ScalingFactor {
+
+    PrecomputedScalingFactor(const PrecomputedScalingFactor &) = delete;
+    PrecomputedScalingFactor & operator=(const PrecomputedScalingFactor &) = delete;
+
+public:
+    PrecomputedScalingFactor(
+        const std::vector<double> & lexicon_factor,
+        double grammar_factor)
+        : lexicon_factor_(lexicon_factor)
+        , grammar_factor_(grammar_factor) {}
+    ~PrecomputedScalingFactor() {}
+
+    double getLexiconScalingFactor(int word_id) const {
+        return (word_id != -1) ? lexicon_factor_.at(word_id) : 1.0;
+    }
+    double getGrammarScalingFactor() const { return grammar_factor_; }
+
+private:
+    std::vector<double> lexicon_factor_;
+    double grammar_factor_;
+
+}; // class PrecomputedScalingFactor
+
+} // namespace Ckylark
+
+#endif // CKYLARK_PRECOMPUTED_SCALING_FACTOR_H_
@@ -0,0 +1,36 @@
+#ifndef CKYLARK_SCALAR_SCORE_KERNEL_H_
+#define CKYLARK_SCALAR_SCORE_KERNEL_H_
+
+#include <ckylark/ScoreKernel.h>
+
+namespace Ckylark {
+
+// reference implementation without SIMD
+class ScalarScoreKernel : public ScoreKernel {
+
+    ScalarScoreKernel(const ScalarScoreKernel &) = delete;
+    ScalarScoreKernel & operator=(const ScalarScoreKernel &) = delete;
+
+public:
+    ScalarScoreKernel() {}
+    ~ScalarScoreKernel() {}
+
+    std::string getName() const { return "scalar"; }
+
+    double binaryInside(
+        const double * rows, int stride, uint64_t row_mask,
+        const double * left, uint64_t lmask,
+        const double * right, uint64_t rmask) const;
+
+    void binaryOutside(
+        const double * rows, int stride, uint64_t row_mask, double parent,
+        const double * left, uint64_t lmask, double * outside_left,
+        const double * right, uint64_t rmask, double * outside_right) const;
+
+    void accumulate(double * dest, double scale, const double * src, int size) const;
+
+}; // class ScalarScoreKernel
+
+} // namespace Ckylark
+
+#endif // CKYLARK_SCALAR_SCORE_KERNEL_H_
@@ -0,0 +1,46 @@
+#ifndef CKYLARK_SCORE_KERNEL_H_
+#define CKYLARK_SCORE_KERNEL_H_
+
+#include <cstdint>
+#include <string>
+
+namespace Ckylark {
+
+// innermost contractions of CKY passes over subtag vectors
+class ScoreKernel {
+
+    ScoreKernel(const ScoreKernel &) = delete;
+    ScoreKernel & operator=(const ScoreKernel &) = delete;
+
+public:
+    ScoreKernel() {}
+    virtual ~ScoreKernel() {}
+
+    virtual std::string getName() const = 0;
+
+    // sum of left[l] * rows[l][r] * right[r] over l in lmask, r in rmask.
+    // rows: binary rule rows of CompiledGrammar (1 row per bit of row_mask, aligned)
+    // stride: distance between 2 rows (multiple of 4)
+    // subtags out of row_mask are skipped.
+    virtual double binaryInside(
+        const double * rows, int stride, uint64_t row_mask,
+        const double * left, uint64_t lmask,
+        const double * right, uint64_t rmask) const = 0;
+
+    // outside_left[l] += parent * sum of rows[l][r] * right[r] over r in rmask,
+    //   for l in lmask which left[l] != 0.
+    // outside_right[r] += parent * sum of left[l] * rows[l][r] over l in lmask,
+    //   for r in rmask which right[r] != 0.
+    virtual void binaryOutside(
+        const double * rows, int stride, uint64_t row_mask, double parent,
+        const double * left, uint64_t lmask, double * outside_left,
+        const double * right, uint64_t rmask, double * outside_right) const = 0;
+
+    // dest[i] += scale * src[i] (both aligned, size is a multiple of 4)
+    virtual void accumulate(double * dest, double scale, const double * src, int size) const = 0;
+
+}; // class ScoreKernel
+
+} // namespace Ckylark
+
+#endif // CKYLARK_SCORE_KERNEL_H_
@@ -0,0 +1,30 @@
+#ifndef CKYLARK_SCORE_KERNEL_FACTORY_H_
+#define CKYLARK_SCORE_KERNEL_FACTORY_H_
+
+#include <ckylark/ScoreKernel.h>
+
+#include <memory>
+#include <string>
+
+namespace Ckylark {
+
+class ScoreKernelFactory {
+
+    ScoreKernelFactory() = delete;
+    ScoreKernelFactory(const ScoreKernelFactory &) = delete;
+    ScoreKernelFactory & operator=(const ScoreKernelFactory &) = delete;
+
+public:
+    // name: 'scalar', 'avx2', 'avx512',
+    //       'auto' (fastest one supported by the running CPU), or
+    //       'check' (same as 'auto', but verified by 'scalar' at every call)
+    static std::shared_ptr<ScoreKernel> create(const std::string & name);
+
+    // whether the running CPU can execute the kernel
+    static bool isSupported(const std::string & name);
+
+}; // class ScoreKernelFactory
+
+} // namespace Ckylark
+
+#endif // CKYLARK_SCORE_KERNEL_FACTORY_H_
@@ -17,7 +17,13 @@ public:
     virtual ~SignatureEstimator() {}
 
     // estimate the signature of the location-th word in the sentence
-    virtual std::string getSignature(const std::vector<std::string> & sentence, size_t location) = 0;
+    // (may be called from several threads at the same time)
+    virtual std::string getSignature(const std::vector<std::string> & sentence, size_t location) const = 0;
+
+    // if signatures depend only on the word and a small class of the location,
+    // returns the class (>= 0) so that signatures can be memoized by the word and it.
+    // returns -1 if signatures depend on other context.
+    virtual int getLocationClass(const std::vector<std::string> & sentence, size_t location) const { return -1; }
 
 }; // class SignatureEstimator
 
@@ -4,10 +4,28 @@
 #include <ckylark/CharUtil.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 
 namespace Ckylark {
 
+// reference to the part of a string: [begin, end)
+// (C++11 does not have std::string_view)
+struct StringPiece {
+    const char * begin;
+    const char * end;
+
+    inline size_t size() const { return end - begin; }
+    inline bool empty() const { return begin == end; }
+    inline std::string str() const { return std::string(begin, end); }
+
+    inline bool equals(const std::string & other) const {
+        return size() == other.size() && std::equal(begin, end, other.begin());
+    }
+}; // struct StringPiece
+
 // utility functions for string processing
 class StringUtil {
 
@@ -90,6 +108,64 @@ public:
     // count the number of lowercase alphabet in str
     inline static size_t numLower(const std::string & str) { return numCharRange(str, 'a', 'z'); }
 
+    // split str by any character in delims without copying.
+    // adjacent delimiters make empty pieces (same as boost::split()).
+    // returns the number of all pieces, and stores at most max_pieces of them.
+    inline static size_t splitPieces(
+        const std::string & str,
+        const char * delims,
+        StringPiece * pieces,
+        size_t max_pieces) {
+
+        const char * p = str.data();
+        const char * end = p + str.size();
+        size_t n = 0;
+        while (true) {
+            const char * q = p;
+            while (q != end && !std::strchr(delims, *q)) ++q;
+            if (n < max_pieces) pieces[n] = StringPiece { p, q };
+            ++n;
+            if (q == end) break;
+            p = q + 1;
+        }
+        return n;
+    }
+
+    // parse the whole piece as a decimal integer, false if failed
+    inline static bool parseInt(const StringPiece & piece, int & value) {
+        const char * p = piece.begin;
+        bool negative = (p != piece.end && *p == '-');
+        if (negative) ++p;
+        if (p == piece.end) return false;
+        long long x = 0;
+        for (; p != piece.end; ++p) {
+            if (*p < '0' || *p > '9') return false;
+            x = x * 10 + (*p - '0');
+            if (x > 0x7fffffffLL) return false;
+        }
+        value = static_cast<int>(negative ? -x : x);
+        return true;
+    }
+
+    // parse the whole piece as a floating point number, false if failed or out of range
+    // (same conditions as std::stod() throws)
+    inline static bool parseDouble(const StringPiece & piece, double & value) {
+        char buf[64];
+        std::string long_buf;
+        const char * text = buf;
+        if (piece.size() < sizeof(buf)) {
+            std::copy(piece.begin, piece.end, buf);
+            buf[piece.size()] = '\0';
+        } else {
+            long_buf = piece.str();
+            text = long_buf.c_str();
+        }
+        char * text_end;
+        errno = 0;
+        value = std::strtod(text, &text_end);
+        return text_end != text && text_end == text + piece.size() && errno != ERANGE;
+    }
+
     // make uppercase string
     inline static std::string toUpper(const std::string & str) {
         std::string ret = str;
@@ -1,6 +1,7 @@
 #ifndef CKYLARK_TAG_SET_H_
 #define CKYLARK_TAG_SET_H_
 
+#include <ckylark/BinaryModel.h>
 #include <ckylark/Dictionary.h>
 #include <ckylark/Tree.h>
 #include <ckylark/Stream.h>
@@ -22,6 +23,9 @@ public:
     ~TagSet();
 
     static std::shared_ptr<TagSet> loadFromStream(InputStream & stream);
+    static std::shared_ptr<TagSet> loadFromBinary(BinaryModelReader & reader);
+
+    void saveToBinary(BinaryModelWriter & writer) const;
 
     int getTagId(std::string name) const { return tag_table_.getId(name); }
     std::string getTagName(int id) const { return tag_table_.getWord(id); }
@@ -30,6 +34,9 @@ public:
     inline size_t numTags() const { return tree_list_.size(); }
     inline size_t numSubtags(int tag_id, int level) const { return num_subtags_[tag_id][level]; };
 
+    // [tag] = sum of numSubtags(t, level) for all t < tag, [numTags()] = total
+    inline const std::vector<int> & getSubtagOffsets(int level) const { return subtag_offsets_[level]; }
+
     const Tree<int> & getSubtagTree(int tag_id) const { return *tree_list_[tag_id]; }
 
 private:
@@ -37,9 +44,13 @@ private:
     Dictionary tag_table_;
     std::vector<Tree<int> *> tree_list_;
     std::vector<std::vector<size_t> > num_subtags_;
+    std::vector<std::vector<int> > subtag_offsets_; // [level][tag]
 
     static Tree<int> * makeSubtagTree(const std::vector<std::string> & tok, int & pos);
 
+    // add ROOT tag and calculate #subtags after reading all tags
+    void finishLoading();
+
     void checkDepth();
     static size_t getDepthByNode(Tree<int> & node);
     //static size_t numSubtagsByNode(Tree<int> & node, int rest_depth);
@@ -0,0 +1,51 @@
+#ifndef CKYLARK_TASK_GROUP_H_
+#define CKYLARK_TASK_GROUP_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Ckylark {
+
+// runs independent tasks concurrently on a bounded number of threads.
+// if some tasks throw, the first exception is rethrown by run() after all
+// tasks finished.
+class TaskGroup {
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup & operator=(const TaskGroup &) = delete;
+
+public:
+    // num_threads <= 0: use all hardware threads
+    explicit TaskGroup(int num_threads = 0);
+    ~TaskGroup();
+
+    void add(const std::string & name, const std::function<void()> & func);
+
+    // run all tasks added after the last run()
+    void run();
+
+    inline size_t size() const { return tasks_.size(); }
+    inline const std::string & getName(size_t index) const { return tasks_.at(index).name; }
+
+    // elapsed times of the last run() in seconds
+    inline double getElapsed(size_t index) const { return tasks_.at(index).elapsed; }
+    inline double getWallTime() const { return wall_time_; }
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> func;
+        double elapsed;
+    }; // struct Task
+
+    int num_threads_;
+    std::vector<Task> tasks_;
+    double wall_time_;
+    bool finished_;
+
+}; // class TaskGroup
+
+} // namespace Ckylark
+
+#endif // CKYLARK_TASK_GROUP_H_
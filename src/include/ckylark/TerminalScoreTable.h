@@ -0,0 +1,77 @@
+#ifndef CKYLARK_TERMINAL_SCORE_TABLE_H_
+#define CKYLARK_TERMINAL_SCORE_TABLE_H_
+
+#include <ckylark/OOVLexicon.h>
+#include <ckylark/ScalingFactor.h>
+
+#include <vector>
+
+namespace Ckylark {
+
+// smoothed and scaled terminal scores of each word at one level.
+// scores of lexicon entries are stored per word, and OOV-only scores
+// (tags which the word does not have) are shared by all words and
+// scaled when they are used.
+class TerminalScoreTable {
+
+    TerminalScoreTable() = delete;
+    TerminalScoreTable(const TerminalScoreTable &) = delete;
+    TerminalScoreTable & operator=(const TerminalScoreTable &) = delete;
+
+public:
+    TerminalScoreTable(
+        const OOVLexicon & oov_lexicon,
+        const ScalingFactor & scaling_factor,
+        int num_words,
+        double ratio);
+    ~TerminalScoreTable();
+
+    // calls func(tag_id, scores, factor) in ascending order of tags which may have
+    // nonzero scores. the terminal score of each subtag is factor * scores[subtag].
+    // other tags always have zero scores.
+    template <class Func>
+    void forEachTag(int word_id, Func func) const {
+        const int slot = getWordSlot(word_id);
+        const double word_scaling = word_scaling_[slot];
+        int ent = word_offset_[slot];
+        const int ent_end = word_offset_[slot + 1];
+        int oov = 0;
+        const int oov_end = oov_tag_.size();
+
+        while (ent != ent_end || oov != oov_end) {
+            if (oov == oov_end || (ent != ent_end && entry_tag_[ent] < oov_tag_[oov])) {
+                func(entry_tag_[ent], &score_[entry_pos_[ent]], 1.0);
+                ++ent;
+            } else if (ent == ent_end || oov_tag_[oov] < entry_tag_[ent]) {
+                func(oov_tag_[oov], &oov_score_[oov_pos_[oov]], word_scaling);
+                ++oov;
+            } else {
+                // entry scores already include the OOV part
+                func(entry_tag_[ent], &score_[entry_pos_[ent]], 1.0);
+                ++ent;
+                ++oov;
+            }
+        }
+    }
+
+private:
+    std::vector<int> word_offset_; // [word] = first entry, [num_words] = unknown words, [num_words + 1] = end
+    std::vector<double> word_scaling_; // [word] (unknown words at [num_words])
+    std::vector<int> entry_tag_; // {entry}
+    std::vector<int> entry_pos_; // {entry} = first subtag in score_
+    std::vector<double> score_; // {entry}[subtag] (smoothed and scaled)
+    std::vector<int> oov_tag_; // {tag}
+    std::vector<int> oov_pos_; // {tag} = first subtag in oov_score_
+    std::vector<double> oov_score_; // {tag}[subtag] (smoothed, not scaled)
+
+    inline int getWordSlot(int word_id) const {
+        const int num_words = static_cast<int>(word_scaling_.size()) - 1;
+        return (word_id >= 0 && word_id < num_words) ? word_id : num_words;
+    }
+
+}; // class TerminalScoreTable
+
+} // namespace Ckylark
+
+#endif // CKYLARK_TERMINAL_SCORE_TABLE_H_
+
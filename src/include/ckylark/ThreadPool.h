@@ -0,0 +1,77 @@
+#ifndef CKYLARK_THREAD_POOL_H_
+#define CKYLARK_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Ckylark {
+
+// persistent threads which process indices of parallel loops.
+// unlike TaskGroup, threads are kept between loops, so a loop is cheap enough
+// to be used for each step of a parse.
+class ThreadPool {
+
+    ThreadPool() = delete;
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+public:
+    // num_threads: total threads used by each loop including the caller (>= 1)
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    inline int numThreads() const { return num_threads_; }
+
+    // call func(index, slot) for each index in [0, size), and return after all calls.
+    // slot in [0, numThreads()) is unique among threads working on the same loop
+    // (the caller always uses 0), and can be used to select per-thread buffers.
+    // loops can be started from several threads at the same time.
+    // if some calls throw, the first exception in the order of indices is rethrown.
+    // func is called through a plain pointer, so a loop does not allocate memory.
+    template <typename Func>
+    void parallelFor(int size, const Func & func) {
+        runLoop(size, &ThreadPool::invoke<Func>, &func);
+    }
+
+private:
+    typedef void (*LoopFunc)(const void * context, int index, int slot);
+
+    struct Loop {
+        LoopFunc func;
+        const void * context;
+        int size;
+        std::atomic<int> next_index;
+        int next_slot; // guarded by mutex_
+        int num_active; // guarded by mutex_
+        std::exception_ptr error; // guarded by mutex_
+        int error_index; // guarded by mutex_
+    }; // struct Loop
+
+    int num_threads_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_cond_;
+    std::condition_variable done_cond_;
+    std::deque<Loop *> loops_; // loops which have unclaimed indices
+    bool stopping_;
+
+    template <typename Func>
+    static void invoke(const void * context, int index, int slot) {
+        (*static_cast<const Func *>(context))(index, slot);
+    }
+
+    void runLoop(int size, LoopFunc func, const void * context);
+    void runWorker();
+    void processLoop(Loop & loop, int slot);
+
+}; // class ThreadPool
+
+} // namespace Ckylark
+
+#endif // CKYLARK_THREAD_POOL_H_
+
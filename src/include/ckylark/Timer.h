@@ -1,7 +1,7 @@
 #ifndef CKYLARK_TIMER_H_
 #define CKYLARK_TIMER_H_
 
-#include <ctime>
+#include <chrono>
 
 namespace Ckylark {
 
@@ -22,8 +22,10 @@ public:
     double elapsed() const;
 
 private:
-    clock_t elapsed_;
-    clock_t start_time_;
+    // wall-clock time: clock() is the CPU time of the whole process and
+    // cannot measure a lap while other threads are running.
+    std::chrono::steady_clock::duration elapsed_;
+    std::chrono::steady_clock::time_point start_time_;
     bool running_;
 
 }; // class Timer
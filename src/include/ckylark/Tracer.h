@@ -1,10 +1,14 @@
 #ifndef CKYLARK_TRACER_H_
 #define CKYLARK_TRACER_H_
 
+#include <atomic>
 #include <string>
 
 namespace Ckylark {
 
+// writes tracing texts into stderr.
+// each call writes its text at once under a lock, so texts of different threads
+// are not mixed within a call.
 class Tracer {
 
     Tracer() = delete;
@@ -19,11 +23,12 @@ public:
     static void setTraceLevel(unsigned int value);
 
 private:
-    static unsigned int trace_level_;
+    static std::atomic<unsigned int> trace_level_;
+
+    static void write(const std::string & text);
 
 }; // class Tracer
 
 } // namespace Ckylark
 
 #endif // CKYLARK_TRACER_H_
-
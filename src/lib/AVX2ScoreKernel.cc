@@ -0,0 +1,119 @@
+#include <ckylark/AVX2ScoreKernel.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <ckylark/BitUtil.h>
+
+#include <immintrin.h>
+
+using namespace std;
+
+namespace Ckylark {
+
+// these functions are compiled for AVX2 regardless of the compiler flags,
+// and are called only if ScoreKernelFactory found the instructions at runtime.
+#define CKYLARK_AVX2_TARGET __attribute__((target("avx2,fma,popcnt")))
+
+namespace {
+
+// lanes of the 4-wide block at i which are in mask
+CKYLARK_AVX2_TARGET
+inline __m256i blockLanes(uint64_t mask, int i) {
+    const __m256i lane_bits = _mm256_set_epi64x(8, 4, 2, 1);
+    __m256i selected = _mm256_and_si256(_mm256_set1_epi64x(mask >> i), lane_bits);
+    return _mm256_cmpeq_epi64(selected, lane_bits);
+}
+
+// zero-filled copy of right scores out of rmask (length: stride)
+CKYLARK_AVX2_TARGET
+inline void maskScores(double * dest, const double * src, uint64_t mask, int stride) {
+    for (int i = 0; i < stride; i += 4) {
+        _mm256_store_pd(dest + i, _mm256_maskload_pd(src + i, blockLanes(mask, i)));
+    }
+}
+
+CKYLARK_AVX2_TARGET
+inline double horizontalSum(__m256d x) {
+    __m128d y = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(y, _mm_unpackhi_pd(y, y)));
+}
+
+} // namespace
+
+CKYLARK_AVX2_TARGET
+double AVX2ScoreKernel::binaryInside(
+    const double * rows, int stride, uint64_t row_mask,
+    const double * left, uint64_t lmask,
+    const double * right, uint64_t rmask) const {
+
+    alignas(32) double masked_right[BitUtil::MAX_BITS];
+    maskScores(masked_right, right, rmask, stride);
+
+    __m256d acc = _mm256_setzero_pd();
+
+    for (uint64_t lsub_mask = lmask & row_mask; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+        int lsub = BitUtil::lowest(lsub_mask);
+        double left_score = left[lsub];
+        if (left_score == 0.0) continue;
+        const double * row = rows + BitUtil::count(row_mask & (BitUtil::bit(lsub) - 1)) * stride;
+        __m256d l = _mm256_set1_pd(left_score);
+
+        for (int i = 0; i < stride; i += 4) {
+            __m256d lr = _mm256_mul_pd(l, _mm256_load_pd(row + i));
+            acc = _mm256_fmadd_pd(lr, _mm256_load_pd(masked_right + i), acc);
+        }
+    }
+
+    return horizontalSum(acc);
+}
+
+CKYLARK_AVX2_TARGET
+void AVX2ScoreKernel::binaryOutside(
+    const double * rows, int stride, uint64_t row_mask, double parent,
+    const double * left, uint64_t lmask, double * outside_left,
+    const double * right, uint64_t rmask, double * outside_right) const {
+
+    alignas(32) double masked_right[BitUtil::MAX_BITS];
+    alignas(32) double delta_right[BitUtil::MAX_BITS];
+    maskScores(masked_right, right, rmask, stride);
+    for (int i = 0; i < stride; i += 4) {
+        _mm256_store_pd(delta_right + i, _mm256_setzero_pd());
+    }
+
+    for (uint64_t lsub_mask = lmask & row_mask; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+        int lsub = BitUtil::lowest(lsub_mask);
+        double left_score = left[lsub];
+        if (left_score == 0.0) continue;
+        const double * row = rows + BitUtil::count(row_mask & (BitUtil::bit(lsub) - 1)) * stride;
+        __m256d pl = _mm256_set1_pd(parent * left_score);
+        __m256d acc = _mm256_setzero_pd();
+
+        for (int i = 0; i < stride; i += 4) {
+            __m256d r = _mm256_load_pd(row + i);
+            acc = _mm256_fmadd_pd(r, _mm256_load_pd(masked_right + i), acc);
+            _mm256_store_pd(delta_right + i, _mm256_fmadd_pd(pl, r, _mm256_load_pd(delta_right + i)));
+        }
+
+        outside_left[lsub] += parent * horizontalSum(acc);
+    }
+
+    // update only allowed subtags which have nonzero inside scores
+    for (int i = 0; i < stride; i += 4) {
+        __m256d nonzero = _mm256_cmp_pd(_mm256_load_pd(masked_right + i), _mm256_setzero_pd(), _CMP_NEQ_OQ);
+        __m256i lanes = _mm256_and_si256(blockLanes(rmask, i), _mm256_castpd_si256(nonzero));
+        __m256d o = _mm256_maskload_pd(outside_right + i, lanes);
+        _mm256_maskstore_pd(outside_right + i, lanes, _mm256_add_pd(o, _mm256_load_pd(delta_right + i)));
+    }
+}
+
+CKYLARK_AVX2_TARGET
+void AVX2ScoreKernel::accumulate(double * dest, double scale, const double * src, int size) const {
+    __m256d s = _mm256_set1_pd(scale);
+    for (int i = 0; i < size; i += 4) {
+        _mm256_store_pd(dest + i, _mm256_fmadd_pd(s, _mm256_load_pd(src + i), _mm256_load_pd(dest + i)));
+    }
+}
+
+} // namespace Ckylark
+
+#endif // x86
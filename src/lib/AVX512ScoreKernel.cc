@@ -0,0 +1,116 @@
+#include <ckylark/AVX512ScoreKernel.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <ckylark/BitUtil.h>
+
+#include <immintrin.h>
+
+using namespace std;
+
+namespace Ckylark {
+
+// these functions are compiled for AVX-512F regardless of the compiler flags,
+// and are called only if ScoreKernelFactory found the instructions at runtime.
+#define CKYLARK_AVX512_TARGET __attribute__((target("avx512f,popcnt")))
+
+namespace {
+
+// lanes of the 8-wide block at i (rows are padded only to 4 values)
+inline __mmask8 blockLanes(int i, int stride) {
+    return (i + 8 <= stride) ? 0xff : 0x0f;
+}
+
+// _mm512_reduce_add_pd() raises false -Wuninitialized on some compilers
+CKYLARK_AVX512_TARGET
+inline double horizontalSum(__m512d x) {
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, x);
+    return ((lanes[0] + lanes[4]) + (lanes[2] + lanes[6])) + ((lanes[1] + lanes[5]) + (lanes[3] + lanes[7]));
+}
+
+} // namespace
+
+CKYLARK_AVX512_TARGET
+double AVX512ScoreKernel::binaryInside(
+    const double * rows, int stride, uint64_t row_mask,
+    const double * left, uint64_t lmask,
+    const double * right, uint64_t rmask) const {
+
+    // zero-filled copy of right scores out of rmask
+    alignas(64) double masked_right[BitUtil::MAX_BITS];
+    for (int i = 0; i < stride; i += 8) {
+        __mmask8 lanes = static_cast<__mmask8>(rmask >> i) & blockLanes(i, stride);
+        _mm512_store_pd(masked_right + i, _mm512_maskz_loadu_pd(lanes, right + i));
+    }
+
+    __m512d acc = _mm512_setzero_pd();
+
+    for (uint64_t lsub_mask = lmask & row_mask; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+        int lsub = BitUtil::lowest(lsub_mask);
+        double left_score = left[lsub];
+        if (left_score == 0.0) continue;
+        const double * row = rows + BitUtil::count(row_mask & (BitUtil::bit(lsub) - 1)) * stride;
+        __m512d l = _mm512_set1_pd(left_score);
+
+        for (int i = 0; i < stride; i += 8) {
+            __m512d lr = _mm512_mul_pd(l, _mm512_maskz_loadu_pd(blockLanes(i, stride), row + i));
+            acc = _mm512_fmadd_pd(lr, _mm512_load_pd(masked_right + i), acc);
+        }
+    }
+
+    return horizontalSum(acc);
+}
+
+CKYLARK_AVX512_TARGET
+void AVX512ScoreKernel::binaryOutside(
+    const double * rows, int stride, uint64_t row_mask, double parent,
+    const double * left, uint64_t lmask, double * outside_left,
+    const double * right, uint64_t rmask, double * outside_right) const {
+
+    alignas(64) double masked_right[BitUtil::MAX_BITS];
+    alignas(64) double delta_right[BitUtil::MAX_BITS];
+    for (int i = 0; i < stride; i += 8) {
+        __mmask8 lanes = static_cast<__mmask8>(rmask >> i) & blockLanes(i, stride);
+        _mm512_store_pd(masked_right + i, _mm512_maskz_loadu_pd(lanes, right + i));
+        _mm512_store_pd(delta_right + i, _mm512_setzero_pd());
+    }
+
+    for (uint64_t lsub_mask = lmask & row_mask; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+        int lsub = BitUtil::lowest(lsub_mask);
+        double left_score = left[lsub];
+        if (left_score == 0.0) continue;
+        const double * row = rows + BitUtil::count(row_mask & (BitUtil::bit(lsub) - 1)) * stride;
+        __m512d pl = _mm512_set1_pd(parent * left_score);
+        __m512d acc = _mm512_setzero_pd();
+
+        for (int i = 0; i < stride; i += 8) {
+            __m512d r = _mm512_maskz_loadu_pd(blockLanes(i, stride), row + i);
+            acc = _mm512_fmadd_pd(r, _mm512_load_pd(masked_right + i), acc);
+            _mm512_store_pd(delta_right + i, _mm512_fmadd_pd(pl, r, _mm512_load_pd(delta_right + i)));
+        }
+
+        outside_left[lsub] += parent * horizontalSum(acc);
+    }
+
+    // update only allowed subtags which have nonzero inside scores
+    for (int i = 0; i < stride; i += 8) {
+        __mmask8 lanes = _mm512_cmp_pd_mask(_mm512_load_pd(masked_right + i), _mm512_setzero_pd(), _CMP_NEQ_OQ);
+        __m512d o = _mm512_maskz_loadu_pd(lanes, outside_right + i);
+        _mm512_mask_storeu_pd(outside_right + i, lanes, _mm512_add_pd(o, _mm512_load_pd(delta_right + i)));
+    }
+}
+
+CKYLARK_AVX512_TARGET
+void AVX512ScoreKernel::accumulate(double * dest, double scale, const double * src, int size) const {
+    __m512d s = _mm512_set1_pd(scale);
+    for (int i = 0; i < size; i += 8) {
+        __mmask8 lanes = blockLanes(i, size);
+        __m512d d = _mm512_maskz_loadu_pd(lanes, dest + i);
+        _mm512_mask_storeu_pd(dest + i, lanes, _mm512_fmadd_pd(s, _mm512_maskz_loadu_pd(lanes, src + i), d));
+    }
+}
+
+} // namespace Ckylark
+
+#endif // x86
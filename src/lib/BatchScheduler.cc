@@ -0,0 +1,178 @@
+#include <ckylark/BatchScheduler.h>
+
+#include <ckylark/Timer.h>
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+namespace Ckylark {
+
+namespace {
+
+// deque of task indices owned by one thread
+struct TaskQueue {
+    mutex lock;
+    deque<size_t> tasks; // in descending order of costs
+    double remaining; // sum of costs in tasks
+}; // struct TaskQueue
+
+} // namespace
+
+BatchScheduler::BatchScheduler(int num_threads)
+    : num_threads_(num_threads)
+    , stats_mutex_()
+    , stats_()
+    , wall_time_(0.0) {
+
+    if (num_threads_ <= 0) {
+        num_threads_ = thread::hardware_concurrency();
+        if (num_threads_ <= 0) num_threads_ = 1;
+    }
+    stats_.assign(num_threads_, Stats { 0, 0, 0.0 });
+}
+
+BatchScheduler::~BatchScheduler() {}
+
+size_t BatchScheduler::getNumTasks(int thread) const {
+    lock_guard<mutex> lock(stats_mutex_);
+    return stats_.at(thread).num_tasks;
+}
+
+size_t BatchScheduler::getNumStolen(int thread) const {
+    lock_guard<mutex> lock(stats_mutex_);
+    return stats_.at(thread).num_stolen;
+}
+
+double BatchScheduler::getBusyTime(int thread) const {
+    lock_guard<mutex> lock(stats_mutex_);
+    return stats_.at(thread).busy_time;
+}
+
+double BatchScheduler::getWallTime() const {
+    lock_guard<mutex> lock(stats_mutex_);
+    return wall_time_;
+}
+
+double BatchScheduler::getUtilization(int thread) const {
+    lock_guard<mutex> lock(stats_mutex_);
+    return wall_time_ > 0.0 ? stats_.at(thread).busy_time / wall_time_ : 0.0;
+}
+
+double BatchScheduler::estimateParseCost(size_t num_words) {
+    // CKY visits O(n^3) split points
+    double n = num_words + 1;
+    return n * n * n;
+}
+
+void BatchScheduler::run(const vector<double> & costs, const function<void(size_t, int)> & func) {
+    Timer wall_timer;
+    wall_timer.start();
+
+    const size_t num_tasks = costs.size();
+    const int num_workers = min<size_t>(num_threads_, num_tasks);
+    vector<exception_ptr> errors(num_tasks);
+    vector<Stats> stats(num_threads_, Stats { 0, 0, 0.0 }); // of this call
+
+    // deal tasks to the least loaded queue in descending order of costs
+    vector<size_t> order(num_tasks);
+    for (size_t i = 0; i < num_tasks; ++i) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+    vector<TaskQueue> queues(max(num_workers, 1));
+    for (TaskQueue & q : queues) q.remaining = 0.0;
+    for (size_t i : order) {
+        TaskQueue & q = *min_element(queues.begin(), queues.end(),
+            [](const TaskQueue & a, const TaskQueue & b) { return a.remaining < b.remaining; });
+        q.tasks.push_back(i);
+        q.remaining += costs[i];
+    }
+
+    // take the next task of the own queue, or steal one from the most loaded queue
+    auto take = [&](int self, size_t & index, bool & stolen) {
+        {
+            TaskQueue & q = queues[self];
+            lock_guard<mutex> lock(q.lock);
+            if (!q.tasks.empty()) {
+                index = q.tasks.front();
+                q.tasks.pop_front();
+                q.remaining -= costs[index];
+                stolen = false;
+                return true;
+            }
+        }
+        while (true) {
+            int victim = -1;
+            double max_remaining = 0.0;
+            for (int w = 0; w < num_workers; ++w) {
+                if (w == self) continue;
+                lock_guard<mutex> lock(queues[w].lock);
+                if (!queues[w].tasks.empty() && (victim == -1 || queues[w].remaining > max_remaining)) {
+                    victim = w;
+                    max_remaining = queues[w].remaining;
+                }
+            }
+            if (victim == -1) return false;
+
+            TaskQueue & q = queues[victim];
+            lock_guard<mutex> lock(q.lock);
+            if (q.tasks.empty()) continue; // taken by others meanwhile
+            index = q.tasks.back();
+            q.tasks.pop_back();
+            q.remaining -= costs[index];
+            stolen = true;
+            return true;
+        }
+    };
+
+    auto worker = [&](int self) {
+        Stats & my_stats = stats[self];
+        Timer timer;
+        size_t index;
+        bool stolen;
+        while (take(self, index, stolen)) {
+            timer.start();
+            try {
+                func(index, self);
+            } catch (...) {
+                errors[index] = current_exception();
+            }
+            my_stats.busy_time += timer.stop();
+            ++my_stats.num_tasks;
+            if (stolen) ++my_stats.num_stolen;
+        }
+    };
+
+    if (num_workers <= 1) {
+        worker(0);
+    } else {
+        vector<thread> workers;
+        for (int i = 0; i < num_workers; ++i) {
+            workers.push_back(thread(worker, i));
+        }
+        for (thread & t : workers) {
+            t.join();
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(stats_mutex_);
+        for (int i = 0; i < num_threads_; ++i) {
+            stats_[i].num_tasks += stats[i].num_tasks;
+            stats_[i].num_stolen += stats[i].num_stolen;
+            stats_[i].busy_time += stats[i].busy_time;
+        }
+        wall_time_ += wall_timer.stop();
+    }
+
+    for (exception_ptr & error : errors) {
+        if (error) rethrow_exception(error);
+    }
+}
+
+} // namespace Ckylark
+
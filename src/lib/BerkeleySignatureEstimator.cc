@@ -19,7 +19,7 @@ BerkeleySignatureEstimator::BerkeleySignatureEstimator(
     : lang_(lang)
     , known_words_(known_words) {}
 
-string BerkeleySignatureEstimator::getSignature(const vector<string> & sentence, size_t location) {
+string BerkeleySignatureEstimator::getSignature(const vector<string> & sentence, size_t location) const {
     if (location >= sentence.size())
         throw runtime_error("BerkeleySignatureEstimator::getSignature: invalid location");
 
@@ -31,11 +31,16 @@ string BerkeleySignatureEstimator::getSignature(const vector<string> & sentence,
     }
 }
 
-string BerkeleySignatureEstimator::getOtherSignature(const vector<string> & sentence, size_t location) {
+int BerkeleySignatureEstimator::getLocationClass(const vector<string> & sentence, size_t location) const {
+    // English signatures distinguish only the first word (-INITC)
+    return (lang_ == English && location == 0) ? 1 : 0;
+}
+
+string BerkeleySignatureEstimator::getOtherSignature(const vector<string> & sentence, size_t location) const {
     return "UNK";
 }
 
-string BerkeleySignatureEstimator::getEnglishSignature(const vector<string> & sentence, size_t location) {
+string BerkeleySignatureEstimator::getEnglishSignature(const vector<string> & sentence, size_t location) const {
     const string & word = sentence[location];
     string signature = "UNK";
     
@@ -0,0 +1,95 @@
+#include <ckylark/BinaryModel.h>
+
+#include <boost/format.hpp>
+
+using namespace std;
+
+namespace Ckylark {
+
+const size_t BinaryModel::ALIGNMENT;
+const uint32_t BinaryModel::VERSION;
+const uint32_t BinaryModel::BYTE_ORDER_MARK;
+const char BinaryModel::MAGIC[8] = { 'C', 'K', 'Y', 'L', 'A', 'R', 'K', 'B' };
+
+bool BinaryModel::isBinaryModel(const string & path) {
+    ifstream ifs(path, ios::in | ios::binary);
+    char magic[sizeof(MAGIC)];
+    if (!ifs.read(magic, sizeof(magic))) return false;
+    return memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+BinaryModelWriter::BinaryModelWriter(const string & path)
+    : ofs_(path, ios::out | ios::binary | ios::trunc)
+    , pos_(0) {
+
+    if (!ofs_.is_open()) {
+        throw runtime_error("BinaryModelWriter::BinaryModelWriter(): cannot open file: " + path);
+    }
+
+    writeBytes(BinaryModel::MAGIC, sizeof(BinaryModel::MAGIC));
+    write<uint32_t>(BinaryModel::VERSION);
+    write<uint32_t>(BinaryModel::BYTE_ORDER_MARK);
+}
+
+BinaryModelWriter::~BinaryModelWriter() {}
+
+void BinaryModelWriter::close() {
+    ofs_.close();
+    if (ofs_.fail()) {
+        throw runtime_error("BinaryModelWriter::close(): cannot write file");
+    }
+}
+
+void BinaryModelWriter::writeBytes(const void * data, size_t size) {
+    if (!ofs_.write(static_cast<const char *>(data), size)) {
+        throw runtime_error("BinaryModelWriter::writeBytes(): cannot write file");
+    }
+    pos_ += size;
+}
+
+void BinaryModelWriter::pad() {
+    static const char zeros[BinaryModel::ALIGNMENT] = {};
+    size_t rest = (BinaryModel::ALIGNMENT - pos_ % BinaryModel::ALIGNMENT) % BinaryModel::ALIGNMENT;
+    writeBytes(zeros, rest);
+}
+
+BinaryModelReader::BinaryModelReader(const shared_ptr<const MappedFile> & file)
+    : file_(file)
+    , pos_(0) {
+
+    const string & path = file_->getPath();
+
+    if (file_->size() < sizeof(BinaryModel::MAGIC) ||
+        memcmp(file_->data(), BinaryModel::MAGIC, sizeof(BinaryModel::MAGIC)) != 0) {
+        throw runtime_error("BinaryModelReader::BinaryModelReader(): not a binary model: " + path);
+    }
+    pos_ += sizeof(BinaryModel::MAGIC);
+
+    uint32_t version = read<uint32_t>();
+    if (version != BinaryModel::VERSION) {
+        throw runtime_error((boost::format(
+            "BinaryModelReader::BinaryModelReader(): unsupported version %d (expected %d): %s")
+            % version % BinaryModel::VERSION % path).str());
+    }
+    if (read<uint32_t>() != BinaryModel::BYTE_ORDER_MARK) {
+        throw runtime_error("BinaryModelReader::BinaryModelReader(): byte order mismatched: " + path);
+    }
+}
+
+BinaryModelReader::~BinaryModelReader() {}
+
+const void * BinaryModelReader::readBytes(size_t size) {
+    if (size > file_->size() - pos_) {
+        throw runtime_error("BinaryModelReader::readBytes(): unexpected end of file: " + file_->getPath());
+    }
+    const void * data = file_->data() + pos_;
+    pos_ += size;
+    return data;
+}
+
+void BinaryModelReader::skipPadding() {
+    size_t rest = (BinaryModel::ALIGNMENT - pos_ % BinaryModel::ALIGNMENT) % BinaryModel::ALIGNMENT;
+    readBytes(rest);
+}
+
+} // namespace Ckylark
@@ -0,0 +1,82 @@
+#include <ckylark/CheckedScoreKernel.h>
+
+#include <ckylark/BitUtil.h>
+
+#include <boost/format.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace Ckylark {
+
+constexpr double CheckedScoreKernel::TOLERANCE;
+
+CheckedScoreKernel::CheckedScoreKernel(
+    shared_ptr<ScoreKernel> reference,
+    shared_ptr<ScoreKernel> target)
+    : reference_(reference)
+    , target_(target) {}
+
+string CheckedScoreKernel::getName() const {
+    return target_->getName() + " (checked by " + reference_->getName() + ")";
+}
+
+double CheckedScoreKernel::binaryInside(
+    const double * rows, int stride, uint64_t row_mask,
+    const double * left, uint64_t lmask,
+    const double * right, uint64_t rmask) const {
+
+    double expected = reference_->binaryInside(rows, stride, row_mask, left, lmask, right, rmask);
+    double actual = target_->binaryInside(rows, stride, row_mask, left, lmask, right, rmask);
+    check("binaryInside", expected, actual);
+    return actual;
+}
+
+void CheckedScoreKernel::binaryOutside(
+    const double * rows, int stride, uint64_t row_mask, double parent,
+    const double * left, uint64_t lmask, double * outside_left,
+    const double * right, uint64_t rmask, double * outside_right) const {
+
+    // both kernels accumulate into zero-filled copies, then results are compared
+    double expected_left[BitUtil::MAX_BITS] = {};
+    double expected_right[BitUtil::MAX_BITS] = {};
+    double actual_left[BitUtil::MAX_BITS] = {};
+    double actual_right[BitUtil::MAX_BITS] = {};
+    reference_->binaryOutside(rows, stride, row_mask, parent, left, lmask, expected_left, right, rmask, expected_right);
+    target_->binaryOutside(rows, stride, row_mask, parent, left, lmask, actual_left, right, rmask, actual_right);
+
+    for (uint64_t lsub_mask = lmask; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+        int lsub = BitUtil::lowest(lsub_mask);
+        check("binaryOutside", expected_left[lsub], actual_left[lsub]);
+        outside_left[lsub] += actual_left[lsub];
+    }
+    for (uint64_t rsub_mask = rmask; rsub_mask; rsub_mask = BitUtil::dropLowest(rsub_mask)) {
+        int rsub = BitUtil::lowest(rsub_mask);
+        check("binaryOutside", expected_right[rsub], actual_right[rsub]);
+        outside_right[rsub] += actual_right[rsub];
+    }
+}
+
+void CheckedScoreKernel::accumulate(double * dest, double scale, const double * src, int size) const {
+    vector<double> expected(dest, dest + size);
+    reference_->accumulate(expected.data(), scale, src, size);
+    target_->accumulate(dest, scale, src, size);
+
+    for (int i = 0; i < size; ++i) {
+        check("accumulate", expected[i], dest[i]);
+    }
+}
+
+void CheckedScoreKernel::check(const string & func, double expected, double actual) const {
+    double bound = TOLERANCE * max(fabs(expected), fabs(actual));
+    if (fabs(expected - actual) > bound) {
+        throw runtime_error(
+            (boost::format("CheckedScoreKernel::%s(): %s returned %.17e, but %s returned %.17e")
+                % func % target_->getName() % actual % reference_->getName() % expected).str());
+    }
+}
+
+} // namespace Ckylark
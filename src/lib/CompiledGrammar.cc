@@ -0,0 +1,236 @@
+#include <ckylark/CompiledGrammar.h>
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+namespace Ckylark {
+
+namespace {
+
+// round up the number of values to keep every row aligned
+inline size_t padRow(size_t n) {
+    const size_t unit = CompiledGrammar::ALIGNMENT / sizeof(double);
+    return (n + unit - 1) / unit * unit;
+}
+
+} // namespace
+
+CompiledGrammar::CompiledGrammar(const Grammar & grammar)
+    : level_(grammar.getLevel())
+    , binary_parent_(grammar.getTagSet().numTags())
+    , unary_parent_(grammar.getTagSet().numTags())
+    , unary_child_(grammar.getTagSet().numTags())
+    , row_mask_()
+    , row_offset_()
+    , buffer_()
+    , scores_(nullptr)
+    , size_(0)
+    , file_() {
+
+    const TagSet & tag_set = grammar.getTagSet();
+    const int num_tags = tag_set.numTags();
+    size_t size = 0;
+
+    // make layouts of binary rules
+
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        for (const BinaryRule * rule : grammar.getBinaryRuleList(ptag)) {
+            auto & score_list = rule->getScoreList();
+            int num_psub = rule->numParentSubtags();
+            int num_lsub = rule->numLeftSubtags();
+            CompiledBinaryRule crule {
+                rule->parent(),
+                rule->left(),
+                rule->right(),
+                static_cast<int>(padRow(rule->numRightSubtags())),
+                0,
+                row_mask_.size() };
+
+            for (int psub = 0; psub < num_psub; ++psub) {
+                auto & score_list_p = score_list[psub];
+                uint64_t mask = 0;
+                if (!score_list_p.empty()) {
+                    crule.parent_mask |= BitUtil::bit(psub);
+                    for (int lsub = 0; lsub < num_lsub; ++lsub) {
+                        if (!score_list_p[lsub].empty()) {
+                            mask |= BitUtil::bit(lsub);
+                        }
+                    }
+                }
+                row_mask_.push_back(mask);
+                row_offset_.push_back(size);
+                size += BitUtil::count(mask) * crule.stride;
+            }
+
+            binary_parent_[ptag].push_back(crule);
+        }
+    }
+
+    // make layouts of unary rules
+
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        for (const UnaryRule * rule : grammar.getUnaryRuleListByPC()[ptag]) {
+            auto & score_list = rule->getScoreList();
+            int num_psub = rule->numParentSubtags();
+            size_t stride = padRow(rule->numChildSubtags());
+            CompiledUnaryRule crule {
+                rule->parent(),
+                rule->child(),
+                0,
+                row_mask_.size() };
+
+            for (int psub = 0; psub < num_psub; ++psub) {
+                row_mask_.push_back(0);
+                row_offset_.push_back(size);
+                if (!score_list[psub].empty()) {
+                    crule.parent_mask |= BitUtil::bit(psub);
+                    size += stride;
+                }
+            }
+
+            unary_parent_[ptag].push_back(crule);
+        }
+    }
+
+    // keep the same order as Grammar::getUnaryRuleListByCP()
+    for (int ctag = 0; ctag < num_tags; ++ctag) {
+        for (const UnaryRule * rule : grammar.getUnaryRuleListByCP()[ctag]) {
+            for (const CompiledUnaryRule & crule : unary_parent_[rule->parent()]) {
+                if (crule.child == ctag) {
+                    unary_child_[ctag].push_back(crule);
+                    break;
+                }
+            }
+        }
+    }
+
+    // allocate aligned buffer
+
+    double * scores = allocateScores(size);
+
+    // copy scores
+
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        auto & rules = grammar.getBinaryRuleList(ptag);
+        for (size_t i = 0; i < rules.size(); ++i) {
+            auto & score_list = rules[i]->getScoreList();
+            const CompiledBinaryRule & crule = binary_parent_[ptag][i];
+
+            for (uint64_t psub_mask = crule.parent_mask; psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                int psub = BitUtil::lowest(psub_mask);
+                double * row = scores + row_offset_[crule.psub_begin + psub];
+
+                for (uint64_t lsub_mask = row_mask_[crule.psub_begin + psub]; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+                    int lsub = BitUtil::lowest(lsub_mask);
+                    auto & score_list_pl = score_list[psub][lsub];
+                    copy(score_list_pl.begin(), score_list_pl.end(), row);
+                    row += crule.stride;
+                }
+            }
+        }
+    }
+
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        auto & rules = grammar.getUnaryRuleListByPC()[ptag];
+        for (size_t i = 0; i < rules.size(); ++i) {
+            auto & score_list = rules[i]->getScoreList();
+            const CompiledUnaryRule & crule = unary_parent_[ptag][i];
+
+            for (uint64_t psub_mask = crule.parent_mask; psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                int psub = BitUtil::lowest(psub_mask);
+                auto & score_list_p = score_list[psub];
+                copy(score_list_p.begin(), score_list_p.end(), scores + row_offset_[crule.psub_begin + psub]);
+            }
+        }
+    }
+}
+
+CompiledGrammar::CompiledGrammar(int level)
+    : level_(level)
+    , binary_parent_()
+    , unary_parent_()
+    , unary_child_()
+    , row_mask_()
+    , row_offset_()
+    , buffer_()
+    , scores_(nullptr)
+    , size_(0)
+    , file_() {
+}
+
+CompiledGrammar::~CompiledGrammar() {}
+
+shared_ptr<CompiledGrammar> CompiledGrammar::loadFromBinary(
+    BinaryModelReader & reader,
+    const TagSet & tag_set,
+    int level) {
+
+    static_assert(BinaryModel::ALIGNMENT % ALIGNMENT == 0, "CompiledGrammar: alignment mismatched");
+
+    shared_ptr<CompiledGrammar> grammar(new CompiledGrammar(level));
+    const int num_tags = tag_set.numTags();
+
+    if (reader.read<uint32_t>() != static_cast<uint32_t>(num_tags)) {
+        throw runtime_error("CompiledGrammar::loadFromBinary(): number of tags mismatched");
+    }
+
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        grammar->binary_parent_.push_back(reader.readVector<CompiledBinaryRule>());
+    }
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        grammar->unary_parent_.push_back(reader.readVector<CompiledUnaryRule>());
+    }
+    for (int ctag = 0; ctag < num_tags; ++ctag) {
+        grammar->unary_child_.push_back(reader.readVector<CompiledUnaryRule>());
+    }
+    grammar->row_mask_ = reader.readVector<uint64_t>();
+    grammar->row_offset_ = reader.readVector<size_t>();
+
+    size_t size;
+    const double * scores = reader.readArray<double>(size);
+
+    if (reinterpret_cast<uintptr_t>(scores) % ALIGNMENT == 0) {
+        // use scores on the mapping without copying
+        grammar->scores_ = scores;
+        grammar->size_ = size;
+        grammar->file_ = reader.getFile();
+    } else {
+        copy(scores, scores + size, grammar->allocateScores(size));
+    }
+
+    return grammar;
+}
+
+void CompiledGrammar::saveToBinary(BinaryModelWriter & writer) const {
+    const int num_tags = binary_parent_.size();
+
+    writer.write<uint32_t>(num_tags);
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        writer.writeArray(binary_parent_[ptag]);
+    }
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        writer.writeArray(unary_parent_[ptag]);
+    }
+    for (int ctag = 0; ctag < num_tags; ++ctag) {
+        writer.writeArray(unary_child_[ctag]);
+    }
+    writer.writeArray(row_mask_);
+    writer.writeArray(row_offset_);
+    writer.writeArray(scores_, size_);
+}
+
+double * CompiledGrammar::allocateScores(size_t size) {
+    const size_t margin = ALIGNMENT / sizeof(double);
+    buffer_.assign(size + margin, 0.0);
+    uintptr_t head = reinterpret_cast<uintptr_t>(buffer_.data());
+    uintptr_t aligned = (head + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    double * scores = buffer_.data() + (aligned - head) / sizeof(double);
+    scores_ = scores;
+    size_ = size;
+    return scores;
+}
+
+} // namespace Ckylark
+
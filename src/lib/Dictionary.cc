@@ -1,6 +1,7 @@
 #include <ckylark/Dictionary.h>
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 
@@ -8,23 +9,30 @@ using namespace std;
 
 namespace Ckylark {
 
-Dictionary::Dictionary() {}
+Dictionary::Dictionary()
+    : slot_(16, -1)
+    , hash_()
+    , rev_() {}
 
 Dictionary::~Dictionary() {}
 
 void Dictionary::addWord(const string & word) {
-    map<string, int>::iterator it = ids_.find(word);
-    if (it == ids_.end()) {
-        // add new word
-        int id = ids_.size();
-        ids_.insert(make_pair(word, id));
-        rev_.push_back(word);
+    if (find(word.data(), word.size()) != -1) return;
+
+    // keep the load factor at most 1/2
+    if (2 * (rev_.size() + 1) > slot_.size()) {
+        rehash(2 * slot_.size());
     }
-}
 
-int Dictionary::getId(const string & word) const {
-    map<string, int>::const_iterator it = ids_.find(word);
-    return it == ids_.end() ? -1 : it->second;
+    // add new word
+    int id = rev_.size();
+    uint32_t hash = calculateHash(word.data(), word.size());
+    size_t mask = slot_.size() - 1;
+    size_t pos = hash & mask;
+    while (slot_[pos] != -1) pos = (pos + 1) & mask;
+    slot_[pos] = id;
+    hash_.push_back(hash);
+    rev_.push_back(word);
 }
 
 string Dictionary::getWord(int id) const {
@@ -36,5 +44,37 @@ string Dictionary::getWord(int id) const {
     return rev_[id];
 }
 
-} // namespace Ckylark
+uint32_t Dictionary::calculateHash(const char * str, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int Dictionary::find(const char * str, size_t len) const {
+    uint32_t hash = calculateHash(str, len);
+    size_t mask = slot_.size() - 1;
+    for (size_t pos = hash & mask; slot_[pos] != -1; pos = (pos + 1) & mask) {
+        int id = slot_[pos];
+        const string & word = rev_[id];
+        if (hash_[id] == hash && word.size() == len && memcmp(word.data(), str, len) == 0) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+void Dictionary::rehash(size_t num_slots) {
+    slot_.assign(num_slots, -1);
+    size_t mask = num_slots - 1;
+    for (size_t id = 0; id < rev_.size(); ++id) {
+        size_t pos = hash_[id] & mask;
+        while (slot_[pos] != -1) pos = (pos + 1) & mask;
+        slot_[pos] = id;
+    }
+}
 
+} // namespace Ckylark
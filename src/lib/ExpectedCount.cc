@@ -0,0 +1,155 @@
+#include <ckylark/ExpectedCount.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace Ckylark {
+
+ExpectedCount::ExpectedCount(const TagSet & tag_set, const Grammar & grammar)
+    : level_(grammar.getLevel())
+    , num_iterations_(0)
+    , offset_()
+    , count_() {
+
+    int num_tags = tag_set.numTags();
+    int num_pos = 0;
+    for (int tag = 0; tag < num_tags; ++tag) {
+        offset_.push_back(num_pos);
+        num_pos += tag_set.numSubtags(tag, level_);
+    }
+    int root_pos = offset_[tag_set.getTagId("ROOT")];
+
+    // calculate transition probabilities
+    // T(X -> Y) of each parent tag is accumulated in a dense scratch, and
+    // nonzero entries are stored as sparse rows in ascending order of X.
+
+    vector<int> src_pos; // {X}
+    vector<int> dest_pos; // {Y}
+    vector<double> prob; // {T(X -> Y)}
+
+    vector<double> scratch;
+    vector<int> touched;
+    vector<bool> is_touched;
+
+    for (int ptag = 0; ptag < num_tags; ++ptag) {
+        int psc = tag_set.numSubtags(ptag, level_);
+        scratch.assign(psc * num_pos, 0.0);
+        is_touched.assign(psc * num_pos, false);
+        touched.clear();
+
+        auto add = [&](int p, int y, double score) {
+            int k = p * num_pos + y;
+            if (!is_touched[k]) {
+                is_touched[k] = true;
+                touched.push_back(k);
+            }
+            scratch[k] += score;
+        };
+
+        for (const BinaryRule * rule : grammar.getBinaryRuleList(ptag)) {
+            auto & score_list = rule->getScoreList();
+            int lsc = tag_set.numSubtags(rule->left(), level_);
+            int rsc = tag_set.numSubtags(rule->right(), level_);
+            for (int p = 0; p < psc; ++p) {
+                auto & score_list_p = score_list[p];
+                if (score_list_p.empty()) continue;
+                for (int l = 0; l < lsc; ++l) {
+                    auto & score_list_pl = score_list_p[l];
+                    if (score_list_pl.empty()) continue;
+                    int lm = offset_[rule->left()] + l;
+                    for (int r = 0; r < rsc; ++r) {
+                        int rm = offset_[rule->right()] + r;
+                        double score = score_list_pl[r];
+                        add(p, lm, score);
+                        add(p, rm, score);
+                    }
+                }
+            }
+        }
+
+        for (const UnaryRule * rule : grammar.getUnaryRuleListByPC()[ptag]) {
+            auto & score_list = rule->getScoreList();
+            int csc = tag_set.numSubtags(rule->child(), level_);
+            for (int p = 0; p < psc; ++p) {
+                auto & score_list_p = score_list[p];
+                if (score_list_p.empty()) continue;
+                for (int c = 0; c < csc; ++c) {
+                    add(p, offset_[rule->child()] + c, score_list_p[c]);
+                }
+            }
+        }
+
+        sort(touched.begin(), touched.end());
+        for (int k : touched) {
+            if (scratch[k] == 0.0) continue;
+            src_pos.push_back(offset_[ptag] + k / num_pos);
+            dest_pos.push_back(k % num_pos);
+            prob.push_back(scratch[k]);
+        }
+    }
+
+    // transpose to incoming lists, keeping ascending order of X in each list
+
+    size_t num_entries = prob.size();
+    vector<int> in_offset(num_pos + 1, 0); // [Y] = first entry of Y, [num_pos] = end
+    vector<int> in_src(num_entries); // {X}
+    vector<double> in_prob(num_entries); // {T(X -> Y)}
+
+    for (int y : dest_pos) ++in_offset[y + 1];
+    for (int y = 0; y < num_pos; ++y) in_offset[y + 1] += in_offset[y];
+
+    {
+        vector<int> next(in_offset.begin(), in_offset.end() - 1);
+        for (size_t e = 0; e < num_entries; ++e) {
+            int k = next[dest_pos[e]]++;
+            in_src[k] = src_pos[e];
+            in_prob[k] = prob[e];
+        }
+    }
+
+    // calculate expected counts
+
+    // consumers only use ratios of counts, so the convergence is checked with
+    // normalized counts. this also stops when counts of an inconsistent grammar
+    // diverge with a fixed ratio.
+    const int MAX_ITERATION = 1000;
+    const double TOLERANCE = 1e-12; // maximum L1 distance between normalized counts
+
+    count_.assign(num_pos, 0.0);
+    count_[root_pos] = 1.0;
+    double total = 1.0;
+    vector<double> next_count(num_pos, 0.0);
+
+    while (num_iterations_ < MAX_ITERATION) {
+        double next_total = 0.0;
+
+        for (int y = 0; y < num_pos; ++y) {
+            double sum = (y == root_pos) ? 1.0 : 0.0;
+            for (int k = in_offset[y]; k < in_offset[y + 1]; ++k) {
+                sum += in_prob[k] * count_[in_src[k]];
+            }
+            next_count[y] = sum;
+        }
+        next_count[root_pos] = 1.0;
+
+        for (double c : next_count) next_total += c;
+        if (!isfinite(next_total)) break; // keep last finite counts
+
+        double change = 0.0;
+        for (int y = 0; y < num_pos; ++y) {
+            change += fabs(next_count[y] / next_total - count_[y] / total);
+        }
+
+        count_.swap(next_count);
+        total = next_total;
+        ++num_iterations_;
+        if (change <= TOLERANCE) break;
+    }
+}
+
+ExpectedCount::~ExpectedCount() {}
+
+} // namespace Ckylark
+
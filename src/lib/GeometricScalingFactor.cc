@@ -18,90 +18,24 @@ GeometricScalingFactor::GeometricScalingFactor(
     const TagSet & tag_set,
     const Lexicon & lexicon,
     const Grammar & grammar,
+    const ExpectedCount & expected_count,
     double lexicon_smoothing_factor)
     : lexicon_factor_(word_table.size(), 1.0) {
 
-    // check lexicon/grammar levels
+    // check lexicon/grammar/expected count levels
     int level = lexicon.getLevel();
     if (level != grammar.getLevel()) {
         throw runtime_error("GeometricScalingFactor::GeometricScalingFactor(): lexicon and grammar levels are mismatched.");
     }
+    if (expected_count.getLevel() != level) {
+        throw runtime_error("GeometricScalingFactor::GeometricScalingFactor(): expected count level is mismatched.");
+    }
 
     int num_words = word_table.size();
     int num_tags = tag_set.numTags();
 
     Mapping mapping(tag_set, 0, level);
     int num_fine_pos = mapping.getNumFinePos();
-    int root_pos = mapping.getFinePos(tag_set.getTagId("ROOT"), 0);
-
-    // calculate transition probabilities
-
-    vector<vector<double> > transition_prob(num_fine_pos, vector<double>(num_fine_pos, 0.0));
-
-    for (int ptag = 0; ptag < num_tags; ++ptag) {
-        for (const BinaryRule * rule : grammar.getBinaryRuleList(ptag)) {
-            auto & score_list = rule->getScoreList();
-            int psc = tag_set.numSubtags(rule->parent(), level);
-            int lsc = tag_set.numSubtags(rule->left(), level);
-            int rsc = tag_set.numSubtags(rule->right(), level);
-            for (int p = 0; p < psc; ++p) {
-                auto & score_list_p = score_list[p];
-                if (score_list_p.empty()) continue;
-                int pm = mapping.getFinePos(rule->parent(), p);
-                for (int l = 0; l < lsc; ++l) {
-                    auto & score_list_pl = score_list_p[l];
-                    if (score_list_pl.empty()) continue;
-                    int lm = mapping.getFinePos(rule->left(), l);
-                    for (int r = 0; r < rsc; ++r) {
-                        int rm = mapping.getFinePos(rule->right(), r);
-                        double score = score_list_pl[r];
-                        transition_prob[pm][lm] += score;
-                        transition_prob[pm][rm] += score;
-                    }
-                }
-            }
-        }
-    }
-
-    for (auto & it1 : grammar.getUnaryRuleListByPC()) {
-        for (const UnaryRule * rule : it1) {
-            auto & score_list = rule->getScoreList();
-            int psc = tag_set.numSubtags(rule->parent(), level);
-            int csc = tag_set.numSubtags(rule->child(), level);
-            for (int p = 0; p < psc; ++p) {
-                auto & score_list_p = score_list[p];
-                if (score_list_p.empty()) continue;
-                int pm = mapping.getFinePos(rule->parent(), p);
-                for (int c = 0; c < csc; ++c) {
-                    int cm = mapping.getFinePos(rule->child(), c);
-                    transition_prob[pm][cm] += score_list_p[c];
-                }
-            }
-        }
-    }
-
-    // calculate expected counts
-
-    vector<double> exp_count(num_fine_pos, 0.0);
-    vector<double> temp_count(num_fine_pos, 0.0);
-    exp_count[root_pos] = 1.0;
-    temp_count[root_pos] = 1.0;
-    const int NUM_ITERATION = 50;
-
-    for (int iteration = 0; iteration < NUM_ITERATION; ++iteration) {
-        for (int i = 0; i < num_fine_pos; ++i) {
-            for (int j = 0; j < num_fine_pos; ++j) {
-                temp_count[i] += transition_prob[j][i] * exp_count[j];
-            }
-        }
-
-        for (int i = 0; i < num_fine_pos; ++i) {
-            exp_count[i] = temp_count[i];
-            temp_count[i] = 0.0;
-        }
-        exp_count[root_pos] = 1.0;
-        temp_count[root_pos] = 1.0;
-    }
 
     // calculate conditional probabilities
 
@@ -112,11 +46,11 @@ GeometricScalingFactor::GeometricScalingFactor(
         int num_sub = tag_set.numSubtags(tag, level);
         if (lexicon.hasEntry(tag)) {
             for (int sub = 0; sub < num_sub; ++sub) {
-                semiterminal_total += exp_count[mapping.getFinePos(tag, sub)];
+                semiterminal_total += expected_count.getCount(tag, sub);
             }
         } else {
             for (int sub = 0; sub < num_sub; ++sub) {
-                inner_total += exp_count[mapping.getFinePos(tag, sub)];
+                inner_total += expected_count.getCount(tag, sub);
             }
         }
     }
@@ -129,12 +63,12 @@ GeometricScalingFactor::GeometricScalingFactor(
         if (lexicon.hasEntry(tag)) {
             for (int sub = 0; sub < num_sub; ++sub) {
                 int i = mapping.getFinePos(tag, sub);
-                semiterminal_cond_prob[i] = exp_count[i] / semiterminal_total;
+                semiterminal_cond_prob[i] = expected_count.getCount(tag, sub) / semiterminal_total;
             }
         } else {
             for (int sub = 0; sub < num_sub; ++sub) {
                 int i = mapping.getFinePos(tag, sub);
-                inner_cond_prob[i] = exp_count[i] / inner_total;
+                inner_cond_prob[i] = expected_count.getCount(tag, sub) / inner_total;
             }
         }
     }
@@ -1,5 +1,7 @@
 #include <ckylark/Grammar.h>
 
+#include <ckylark/StringUtil.h>
+
 #include <boost/algorithm/string.hpp>
 
 #include <cmath>
@@ -19,7 +21,9 @@ Grammar::Grammar(const TagSet & tag_set, int level)
     //, binary_parent_right_(tag_set.numTags(), vector<vector<BinaryRule *> >(tag_set.numTags()))
     //, binary_left_right_(tag_set.numTags(), vector<vector<BinaryRule *> >(tag_set.numTags()))
     , unary_parent_(tag_set.numTags())
-    , unary_child_(tag_set.numTags()) {
+    , unary_child_(tag_set.numTags())
+    , binary_index_()
+    , unary_index_() {
 }
 
 Grammar::~Grammar() {
@@ -43,28 +47,53 @@ shared_ptr<Grammar> Grammar::loadFromStream(InputStream & stream, const TagSet &
     BinaryRule * cur_binary = &grm->getBinaryRule(0, 0, 0); // dummy
     UnaryRule * cur_unary = &grm->getUnaryRule(0, 0); // dummy
 
+    // lines are sorted by rules, so the last tag names are cached
+    const int MAX_PIECES = 8;
+    StringPiece ls[MAX_PIECES];
+    string tag_name[3];
+    int tag_id[3] = { -1, -1, -1 };
+
+    auto getTagId = [&](int slot, const StringPiece & name) -> int {
+        if (tag_id[slot] == -1 || !name.equals(tag_name[slot])) {
+            tag_name[slot].assign(name.begin, name.end);
+            tag_id[slot] = tag_set.getTagId(tag_name[slot]);
+        }
+        return tag_id[slot];
+    };
+
+    auto parseInt = [](const StringPiece & piece) -> int {
+        int value;
+        if (!StringUtil::parseInt(piece, value)) throw runtime_error("Grammar: invalid subtag: " + piece.str());
+        return value;
+    };
+
+    auto parseDouble = [](const StringPiece & piece) -> double {
+        double value;
+        if (!StringUtil::parseDouble(piece, value)) throw runtime_error("Grammar: invalid score: " + piece.str());
+        return value;
+    };
+
     string line;
     while (stream.readLine(line)) {
         boost::trim(line);
-        vector<string> ls;
-        boost::split(ls, line, boost::is_any_of("_ "));
+        size_t num_pieces = StringUtil::splitPieces(line, "_ ", ls, MAX_PIECES);
         int pc, lc, rc, psc, lsc, rsc;
         double score;
 
-        switch (ls.size()) {
+        switch (num_pieces) {
         case 8: // binary
             // ROOT tag must be the parent of unary rule
-            if (ls[0] == "ROOT") {
+            if (ls[0].equals("ROOT")) {
                 throw runtime_error("Grammar: ROOT must not be the parent of binary rule");
             }
 
-            pc = tag_set.getTagId(ls[0]);
-            lc = tag_set.getTagId(ls[3]);
-            rc = tag_set.getTagId(ls[5]);
-            psc = stoi(ls[1]);
-            lsc = stoi(ls[4]);
-            rsc = stoi(ls[6]);
-            score = stod(ls[7]);
+            pc = getTagId(0, ls[0]);
+            lc = getTagId(1, ls[3]);
+            rc = getTagId(2, ls[5]);
+            psc = parseInt(ls[1]);
+            lsc = parseInt(ls[4]);
+            rsc = parseInt(ls[6]);
+            score = parseDouble(ls[7]);
             //cout << "binary: " << pc << ' ' << lc << ' ' << rc << ' ' << psc << ' ' << lsc << ' ' << rsc << endl; 
 
             if (cur_binary->parent() != pc || cur_binary->left() != lc || cur_binary->right() != rc) {
@@ -74,11 +103,11 @@ shared_ptr<Grammar> Grammar::loadFromStream(InputStream & stream, const TagSet &
             break;
 
         case 6: // unary
-            pc = tag_set.getTagId(ls[0]);
-            lc = tag_set.getTagId(ls[3]);
-            psc = stoi(ls[1]);
-            lsc = stoi(ls[4]);
-            score = stod(ls[5]);
+            pc = getTagId(0, ls[0]);
+            lc = getTagId(1, ls[3]);
+            psc = parseInt(ls[1]);
+            lsc = parseInt(ls[4]);
+            score = parseDouble(ls[5]);
             if (pc == lc && psc == lsc) break;
             //cout << "unary: " << pc << ' ' << lc << ' ' << psc << ' ' << lsc << endl;
             if (cur_unary->parent() != pc || cur_unary->child() != lc) {
@@ -97,13 +126,14 @@ shared_ptr<Grammar> Grammar::loadFromStream(InputStream & stream, const TagSet &
 
 BinaryRule & Grammar::getBinaryRule(int parent, int left, int right) {
 
-    auto& rules_p = binary_parent_[parent];
-    for (auto* rule : rules_p) {
-        if (rule->left() == left && rule->right() == right) {
-            return *rule;
-        }
+    const uint64_t key = makeKey(parent, left, right);
+    auto it = binary_index_.find(key);
+    if (it != binary_index_.end()) {
+        return *(it->second);
     }
 
+    auto& rules_p = binary_parent_[parent];
+
     //auto& rules_pl = binary_parent_left_[parent][left];
     //auto& rules_pr = binary_parent_right_[parent][right];
     //auto& rules_lr = binary_left_right_[left][right];
@@ -115,23 +145,25 @@ BinaryRule & Grammar::getBinaryRule(int parent, int left, int right) {
     //rules_pl.push_back(rule);
     //rules_pr.push_back(rule);
     //rules_lr.push_back(rule);
+    binary_index_.insert(make_pair(key, rule));
     return *rule;
 }
 
 UnaryRule & Grammar::getUnaryRule(int parent, int child) {
-    auto& rules_p = unary_parent_[parent];
-    for (auto* rule : rules_p) {
-        if (rule->child() == child) {
-            return *rule;
-        }
+    const uint64_t key = makeKey(parent, child);
+    auto it = unary_index_.find(key);
+    if (it != unary_index_.end()) {
+        return *(it->second);
     }
 
+    auto& rules_p = unary_parent_[parent];
     auto& rules_c = unary_child_[child];
     size_t np = tag_set_.numSubtags(parent, level_);
     size_t nc = tag_set_.numSubtags(child, level_);
     UnaryRule * rule = new UnaryRule(parent, child, np, nc);
     rules_p.push_back(rule);
     rules_c.push_back(rule);
+    unary_index_.insert(make_pair(key, rule));
     return *rule;
 }
 
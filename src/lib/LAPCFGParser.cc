@@ -1,5 +1,7 @@
 #include <ckylark/LAPCFGParser.h>
 
+#include <ckylark/BinaryModel.h>
+#include <ckylark/BitUtil.h>
 #include <ckylark/Mapping.h>
 #include <ckylark/ModelProjector.h>
 #include <ckylark/M1ModelProjector.h>
@@ -9,18 +11,24 @@
 #include <ckylark/GeometricScalingFactor.h>
 #include <ckylark/HarmonicScalingFactor.h>
 #include <ckylark/OOVLexiconSmoother.h>
+#include <ckylark/PrecomputedScalingFactor.h>
+#include <ckylark/ScoreKernelFactory.h>
 #include <ckylark/StreamFactory.h>
+#include <ckylark/TaskGroup.h>
+#include <ckylark/Timer.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cmath>
 #include <functional>
 #include <fstream>
 #include <limits>
 #include <stdexcept>
+#include <thread>
 
 #include <iostream> // for debug
 
@@ -28,10 +36,37 @@ using namespace std;
 
 namespace Ckylark {
 
+namespace {
+
+// run all tasks in the group and trace elapsed times
+void runStage(const string & name, TaskGroup & tasks) {
+    Tracer::println(1, name + " ...");
+    tasks.run();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        Tracer::println(1, (boost::format("  %s: %.3fs") % tasks.getName(i) % tasks.getElapsed(i)).str());
+    }
+    Tracer::println(1, (boost::format("  Wall time: %.3fs") % tasks.getWallTime()).str());
+}
+
+// identifies parsers whose results are cached in workspaces
+atomic<uint64_t> next_serial(1);
+
+// first aligned position of a buffer allocated with ALIGNMENT bytes of margin
+inline double * alignBuffer(vector<double> & buffer) {
+    uintptr_t head = reinterpret_cast<uintptr_t>(buffer.data());
+    uintptr_t aligned = (head + CompiledGrammar::ALIGNMENT - 1) / CompiledGrammar::ALIGNMENT * CompiledGrammar::ALIGNMENT;
+    return buffer.data() + (aligned - head) / sizeof(double);
+}
+
+} // namespace
+
 LAPCFGParser::LAPCFGParser()
-    : fine_level_(-1)
+    : serial_(next_serial++)
+    , model_ready_(false)
+    , fine_level_(-1)
     , prune_threshold_(1e-5)
     , smooth_unklex_(0)
+    , scaling_()
     , do_m1_preparse_(false)
     , force_generate_(false) {
 }
@@ -43,26 +78,134 @@ shared_ptr<LAPCFGParser> LAPCFGParser::loadFromBerkeleyDump(
     double smooth_unklex,
     const string & scaling) {
 
+    if (scaling != "max" && scaling != "geometric" && scaling != "harmonic") {
+        throw runtime_error("LAPCFGParser::loadFromBerkeleyDump(): unknown scaling strategy: " + scaling);
+    }
+
     shared_ptr<LAPCFGParser> parser(new LAPCFGParser());
     parser->setUNKLexiconSmoothing(smooth_unklex);
+    parser->scaling_ = scaling;
+
+    // independent stages run concurrently
+    TaskGroup tasks;
 
-    parser->loadWordTable(path + ".words");
-    parser->loadTagSet(path + ".splits");
-    parser->loadLexicon(path + ".lexicon");
-    parser->loadGrammar(path + ".grammar");
+    tasks.add("Words: " + path + ".words", [&]() { parser->loadWordTable(path + ".words"); });
+    tasks.add("Tags: " + path + ".splits", [&]() { parser->loadTagSet(path + ".splits"); });
+    runStage("Loading words and tags", tasks);
+
+    tasks.add("Lexicon: " + path + ".lexicon", [&]() { parser->loadLexicon(path + ".lexicon"); });
+    tasks.add("Grammar: " + path + ".grammar", [&]() { parser->loadGrammar(path + ".grammar"); });
+    runStage("Loading lexicon and grammar", tasks);
+
+    // each coarse level is projected from the next finer level
+    // (other components are generated by parse() only for used levels)
     parser->generateCoarseModels();
-    parser->generateScalingFactors(scaling);
-    parser->setFineLevel(-1);
 
-    parser->sig_est_.reset(new BerkeleySignatureEstimator(
-        BerkeleySignatureEstimator::English,
-        *parser->word_table_));
+    parser->finishLoading();
+
+    return parser;
+}
+
+shared_ptr<LAPCFGParser> LAPCFGParser::loadFromBinary(
+    const string & path,
+    double smooth_unklex,
+    const string & scaling) {
+
+    Tracer::println(1, "Loading binary model: " + path + " ...");
+    Timer timer;
+    timer.start();
+    shared_ptr<LAPCFGParser> parser(new LAPCFGParser());
+    parser->setUNKLexiconSmoothing(smooth_unklex);
+    parser->scaling_ = scaling;
+
+    BinaryModelReader reader(make_shared<MappedFile>(path));
+
+    // scaling factors depend on these settings
+    string model_scaling = reader.readString();
+    double model_smooth_unklex = reader.read<double>();
+    if (model_scaling != scaling || model_smooth_unklex != smooth_unklex) {
+        throw runtime_error((boost::format(
+            "LAPCFGParser::loadFromBinary(): model is compiled with scaling=%s, smooth-unklex=%e")
+            % model_scaling % model_smooth_unklex).str());
+    }
+
+    // words are separated by '\n'
+    parser->word_table_.reset(new Dictionary());
+    string words = reader.readString();
+    for (size_t begin = 0; begin < words.size(); ) {
+        size_t end = words.find('\n', begin);
+        if (end == string::npos) end = words.size();
+        parser->word_table_->addWord(words.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    parser->tag_set_ = TagSet::loadFromBinary(reader);
+    parser->checkTagSet();
+    const int depth = parser->tag_set_->getDepth();
+
+    for (int level = 0; level < depth; ++level) {
+        parser->lexicon_.push_back(Lexicon::loadFromBinary(reader, *parser->tag_set_, level));
+        parser->compiled_grammar_.push_back(CompiledGrammar::loadFromBinary(reader, *parser->tag_set_, level));
+        double grammar_factor = reader.read<double>();
+        vector<double> lexicon_factor = reader.readVector<double>();
+        parser->scaling_factor_.push_back(make_shared<PrecomputedScalingFactor>(lexicon_factor, grammar_factor));
+    }
+
+    parser->m1_lexicon_ = M1Lexicon::loadFromBinary(reader, *parser->word_table_, *parser->tag_set_);
+    parser->m1_grammar_ = M1Grammar::loadFromBinary(reader, *parser->tag_set_);
+    Tracer::println(1, (boost::format("  Wall time: %.3fs") % timer.stop()).str());
+
+    parser->finishLoading();
 
     return parser;
 }
 
+void LAPCFGParser::saveToBinary(const string & path) const {
+    const int depth = tag_set_->getDepth();
+
+    // binary models hold all components
+    TaskGroup tasks;
+    for (int level = 0; level < depth; ++level) {
+        tasks.add((boost::format("Level %d") % level).str(), [this, level]() { prepareLevel(level); });
+    }
+    tasks.add("G-1 model", [this]() { prepareM1Model(); });
+    runStage("Generating all components", tasks);
+
+    Tracer::println(1, "Writing binary model: " + path + " ...");
+    BinaryModelWriter writer(path);
+    
+    writer.writeString(scaling_);
+    writer.write<double>(smooth_unklex_);
+
+    string words;
+    for (const string & word : word_table_->getWordList()) {
+        if (!words.empty()) words += '\n';
+        words += word;
+    }
+    writer.writeString(words);
+
+    tag_set_->saveToBinary(writer);
+    const int num_words = word_table_->size();
+
+    for (int level = 0; level < depth; ++level) {
+        lexicon_[level]->saveToBinary(writer);
+        compiled_grammar_[level]->saveToBinary(writer);
+        const ScalingFactor & sf = getScalingFactor(level);
+        vector<double> lexicon_factor(num_words);
+        for (int wid = 0; wid < num_words; ++wid) {
+            lexicon_factor[wid] = sf.getLexiconScalingFactor(wid);
+        }
+        writer.write<double>(sf.getGrammarScalingFactor());
+        writer.writeArray(lexicon_factor);
+    }
+
+    m1_lexicon_->saveToBinary(writer);
+    m1_grammar_->saveToBinary(writer);
+
+    writer.close();
+}
+
 void LAPCFGParser::loadWordTable(const string & path) {
-    Tracer::println(1, "Loading words: " + path + " ...");
     shared_ptr<InputStream> ifs = StreamFactory::createInputStream(path);
 
     word_table_.reset(new Dictionary());
@@ -78,20 +221,28 @@ void LAPCFGParser::loadWordTable(const string & path) {
 }
 
 void LAPCFGParser::loadTagSet(const string & path) {
-    Tracer::println(1, "Loading tags: " + path + " ...");
     shared_ptr<InputStream> ifs = StreamFactory::createInputStream(path);
     tag_set_ = TagSet::loadFromStream(*ifs);
+    checkTagSet();
+}
+
+void LAPCFGParser::checkTagSet() const {
+    // subtag constraints are stored as 64-bit masks
+    const int depth = tag_set_->getDepth();
+    for (size_t tag = 0; tag < tag_set_->numTags(); ++tag) {
+        if (tag_set_->numSubtags(tag, depth - 1) > BitUtil::MAX_BITS) {
+            throw runtime_error("LAPCFGParser::checkTagSet(): too many subtags: " + tag_set_->getTagName(tag));
+        }
+    }
 }
 
 void LAPCFGParser::loadLexicon(const string & path) {
-    Tracer::println(1, "Loading lexicon: " + path + " ...");
     shared_ptr<InputStream> ifs = StreamFactory::createInputStream(path);
     shared_ptr<Lexicon> lexicon(Lexicon::loadFromStream(*ifs, *word_table_, *tag_set_));
     lexicon_.push_back(lexicon);
 }
 
 void LAPCFGParser::loadGrammar(const string & path) {
-    Tracer::println(1, "Loading grammar: " + path + " ...");
     shared_ptr<InputStream> ifs = StreamFactory::createInputStream(path);
     shared_ptr<Grammar> grammar(Grammar::loadFromStream(*ifs, *tag_set_));
     grammar_.push_back(grammar);
@@ -99,61 +250,220 @@ void LAPCFGParser::loadGrammar(const string & path) {
 
 void LAPCFGParser::generateCoarseModels() {
     const int depth = tag_set_->getDepth();
+    expected_count_.assign(depth, shared_ptr<ExpectedCount>());
 
     // generate Gn-1 ~ G0 grammar/lexicon
+    // (lexicon and grammar of the same level are generated concurrently)
     for (int level = depth-2; level >= 0; --level) {
-        Tracer::println(1, (boost::format("Generating coarse model (level=%d) ...") % level).str());
-        
-        //int fine = grammar_.size() - 1;
-        ModelProjector projector(*tag_set_, *(lexicon_[0]), *(grammar_[0]), level+1, level);
-        lexicon_.insert(lexicon_.begin(), projector.generateLexicon());
-        grammar_.insert(grammar_.begin(), projector.generateGrammar());
+        // grammar_[0] is the level+1 grammar here, and its counts are reused by scaling factors
+        expected_count_[level+1] = make_shared<ExpectedCount>(*tag_set_, *(grammar_[0]));
+        ModelProjector projector(*tag_set_, *(lexicon_[0]), *(grammar_[0]), *(expected_count_[level+1]), level+1, level);
+        shared_ptr<Lexicon> lexicon;
+        shared_ptr<Grammar> grammar;
+
+        TaskGroup tasks;
+        tasks.add("Lexicon", [&]() { lexicon = projector.generateLexicon(); });
+        tasks.add("Grammar", [&]() { grammar = projector.generateGrammar(); });
+        runStage((boost::format("Generating coarse model (level=%d)") % level).str(), tasks);
+
+        lexicon_.insert(lexicon_.begin(), lexicon);
+        grammar_.insert(grammar_.begin(), grammar);
     }
 
-    // generate G-1 grammar/lexicon
-    Tracer::println(1, "Generating G-1 model ...");
-    M1ModelProjector m1_projector(*word_table_, *tag_set_, *(lexicon_[0]), *(grammar_[0]));
-    m1_lexicon_ = m1_projector.generateLexicon();
-    m1_grammar_ = m1_projector.generateGrammar();
+    // max scaling does not use expected counts
+    if (scaling_ == "max") {
+        expected_count_.assign(depth, shared_ptr<ExpectedCount>());
+    }
 }
 
-void LAPCFGParser::generateScalingFactors(const string & name) {
-    
+const ExpectedCount & LAPCFGParser::getExpectedCount(int level) const {
+    if (!expected_count_[level]) {
+        expected_count_[level] = make_shared<ExpectedCount>(*tag_set_, *(grammar_[level]));
+    }
+    return *(expected_count_[level]);
+}
 
-    const int depth = tag_set_->getDepth();
+const CompiledGrammar & LAPCFGParser::getCompiledGrammar(int level) const {
+    prepareLevel(level);
+    return *(compiled_grammar_[level]);
+}
 
-    for (int level = 0; level < depth; ++level) {
-        Tracer::println(1, (boost::format("Generating scaling factors (level=%d) ...") % level).str());
+const ScalingFactor & LAPCFGParser::getScalingFactor(int level) const {
+    prepareLevel(level);
+    return *(scaling_factor_[level]);
+}
 
-        std::shared_ptr<ScalingFactor> sf;
-        if (name == "max") sf.reset(new MaxScalingFactor(*word_table_, *tag_set_, *(lexicon_[level]), *(grammar_[level]), smooth_unklex_));
-        else if (name == "geometric") sf.reset(new GeometricScalingFactor(*word_table_, *tag_set_, *(lexicon_[level]), *(grammar_[level]), smooth_unklex_));
-        else if (name == "harmonic") sf.reset(new HarmonicScalingFactor(*word_table_, *tag_set_, *(lexicon_[level]), *(grammar_[level]), smooth_unklex_));
-        else throw runtime_error("LAPCFGParser::generateScalingFactors: unknown scaling strategy: " + name);
+void LAPCFGParser::prepareModel() const {
+    if (model_ready_) return;
 
-        scaling_factor_.push_back(sf);
-        Tracer::println(2, (boost::format("  Grammar: %e") % sf->getGrammarScalingFactor()).str());
+    // levels are independent each other, so they are generated concurrently.
+    // (concurrent callers wait for the same components by call_once)
+    TaskGroup tasks;
+    for (int level = 0; level <= fine_level_; ++level) {
+        tasks.add((boost::format("Level %d") % level).str(), [this, level]() { prepareLevel(level); });
+    }
+    if (do_m1_preparse_) {
+        tasks.add("G-1 model", [this]() { prepareM1Model(); });
     }
+    runStage("Generating components", tasks);
+
+    model_ready_ = true;
+}
+
+void LAPCFGParser::prepareLevel(int level) const {
+    call_once(level_once_[level], [this, level]() {
+        // packed score buffers used at all CKY passes
+        if (!compiled_grammar_[level]) {
+            compiled_grammar_[level] = make_shared<CompiledGrammar>(*(grammar_[level]));
+        }
+
+        if (!scaling_factor_[level]) {
+            scaling_factor_[level] = generateScalingFactor(level);
+            expected_count_[level].reset(); // not used any more
+        }
+
+        // UNK* entries are summed only once, and terminal scores of all words are
+        // smoothed and scaled in advance
+        OOVLexicon oov_lexicon(*(lexicon_[level]), *word_table_);
+        terminal_score_[level] = make_shared<TerminalScoreTable>(
+            oov_lexicon, *(scaling_factor_[level]), word_table_->size(), smooth_unklex_);
+    });
+}
+
+void LAPCFGParser::prepareM1Model() const {
+    call_once(m1_once_, [this]() {
+        // generate G-1 grammar/lexicon
+        if (!m1_lexicon_) {
+            M1ModelProjector m1_projector(*word_table_, *tag_set_, *(lexicon_[0]), *(grammar_[0]));
+            m1_lexicon_ = m1_projector.generateLexicon();
+            m1_grammar_ = m1_projector.generateGrammar();
+        }
+
+        m1_smoother_.reset(new M1OOVLexiconSmoother(*m1_lexicon_, *word_table_, smooth_unklex_));
+    });
+}
+
+shared_ptr<ScalingFactor> LAPCFGParser::generateScalingFactor(int level) const {
+    const Lexicon & lexicon = *(lexicon_[level]);
+    const Grammar & grammar = *(grammar_[level]);
+    shared_ptr<ScalingFactor> sf;
+    if (scaling_ == "max") sf.reset(new MaxScalingFactor(*word_table_, *tag_set_, lexicon, grammar, smooth_unklex_));
+    else if (scaling_ == "geometric") sf.reset(new GeometricScalingFactor(*word_table_, *tag_set_, lexicon, grammar, getExpectedCount(level), smooth_unklex_));
+    else sf.reset(new HarmonicScalingFactor(*word_table_, *tag_set_, lexicon, grammar, getExpectedCount(level), smooth_unklex_));
+
+    Tracer::println(2, (boost::format("  Grammar scaling factor (level=%d): %e")
+        % level % sf->getGrammarScalingFactor()).str());
+    return sf;
+}
+
+void LAPCFGParser::generateMappings() {
+    const int depth = tag_set_->getDepth();
+
+    // coarse-to-fine mappings used at initializeCharts()
+    mapping_.push_back(shared_ptr<Mapping>()); // no mapping for level 0
+    for (int level = 1; level < depth; ++level) {
+        mapping_.push_back(make_shared<Mapping>(*tag_set_, level - 1, level));
+    }
+}
+
+void LAPCFGParser::finishLoading() {
+    const int depth = tag_set_->getDepth();
+
+    // slots of components generated on the first use
+    // (binary models already have compiled grammars and scaling factors)
+    level_once_.reset(new once_flag[depth]);
+    compiled_grammar_.resize(depth);
+    scaling_factor_.resize(depth);
+    terminal_score_.assign(depth, shared_ptr<TerminalScoreTable>());
+    expected_count_.resize(depth);
+
+    generateMappings();
+    setFineLevel(-1);
+    setScoreKernel(ScoreKernelFactory::create("auto"));
+
+    sig_est_.reset(new BerkeleySignatureEstimator(
+        BerkeleySignatureEstimator::English,
+        *word_table_));
 }
 
 ParserResult LAPCFGParser::parse(
     const vector<string> & sentence,
     const ParserSetting & setting) const {
+
+    // buffers are kept during the lifetime of each thread
+    static thread_local ParseWorkspace workspace;
+    return parse(sentence, setting, workspace);
+}
+
+ParserResult LAPCFGParser::parse(
+    const vector<string> & sentence,
+    const ParserSetting & setting,
+    ParseWorkspace & workspace) const {
     
-    ParserResult result = generateMaxRuleOneBestParse(sentence, setting, fine_level_);
+    // components are generated when the parser first uses them
+    prepareModel();
+
+    ParserResult result = generateMaxRuleOneBestParse(sentence, setting, fine_level_, workspace);
 
     // if full-level parsing is failed, rollback coarse grammar and retry parsing
     if (!result.succeeded && result.final_level > 0) {
-        result = generateMaxRuleOneBestParse(sentence, setting, result.final_level - 1);
+        result = generateMaxRuleOneBestParse(sentence, setting, result.final_level - 1, workspace);
     }
 
     return result;
 }
 
+vector<ParserResult> LAPCFGParser::parseBatch(
+    const vector<vector<string> > & sentences,
+    const ParserSetting & setting,
+    const ParserBatchOptions & options) const {
+
+    prepareModel();
+
+    BatchScheduler local_scheduler(options.num_threads);
+    BatchScheduler & scheduler = options.scheduler ? *options.scheduler : local_scheduler;
+
+    // borrow 1 workspace for each thread
+    const int num_threads = scheduler.numThreads();
+    vector<unique_ptr<ParseWorkspace> > workspace(num_threads);
+    {
+        lock_guard<mutex> lock(workspace_mutex_);
+        for (unique_ptr<ParseWorkspace> & ws : workspace) {
+            if (spare_workspace_.empty()) {
+                ws.reset(new ParseWorkspace());
+            } else {
+                ws = std::move(spare_workspace_.back());
+                spare_workspace_.pop_back();
+            }
+        }
+    }
+
+    auto give_back = [&]() {
+        lock_guard<mutex> lock(workspace_mutex_);
+        for (unique_ptr<ParseWorkspace> & ws : workspace) {
+            spare_workspace_.push_back(std::move(ws));
+        }
+    };
+
+    vector<ParserResult> results;
+    try {
+        results = runBatch(sentences, options, scheduler, [&](size_t i, int thread) {
+            return parse(sentences[i], setting, *workspace[thread]);
+        });
+    } catch (...) {
+        give_back();
+        throw;
+    }
+    give_back();
+
+    return results;
+}
+
 ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
     const vector<string> & sentence,
     const ParserSetting & setting,
-    int final_level_to_try) const {
+    int final_level_to_try,
+    ParseWorkspace & workspace) const {
     
     const int num_words = sentence.size();
     const int num_tags = tag_set_->numTags();
@@ -164,23 +474,36 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
         return ParserResult { getDefaultParse(sentence), true, -1 };
     }
 
-    vector<int> wid_list = makeWordIdList(sentence);
-    vector<int> tid_list = makeTagIdList(sentence);
+    // all buffers are borrowed from the workspace
+    vector<int> & wid_list = workspace.wid_list_;
+    vector<int> & tid_list = workspace.tid_list_;
+    makeWordIdList(sentence, workspace);
+    makeTagIdList(sentence, tid_list);
 
-    CKYTable<bool> allowed_tag(num_words, num_tags);
+    CKYTable<bool> & allowed_tag = workspace.allowed_tag_;
+    allowed_tag.reset(num_words, num_tags);
 
     if (do_m1_preparse_) {
-        doM1Preparse(allowed_tag, wid_list, tid_list, setting.partial);
+        doM1Preparse(allowed_tag, wid_list, tid_list, workspace.m1_inside_, workspace.m1_outside_, setting.partial);
     }
 
-    CKYTable<vector<bool> > allowed_sub(num_words, num_tags);
-    CKYTable<vector<double> > inside(num_words, num_tags);
-    CKYTable<vector<double> > outside(num_words, num_tags);
-    vector<vector<Extent> > extent(num_words + 1, vector<Extent>(num_tags, {
+    CKYTable<uint64_t> & allowed_sub = workspace.allowed_sub_;
+    allowed_sub.reset(num_words, num_tags);
+    CKYChart<double> & inside = workspace.inside_;
+    CKYChart<double> & outside = workspace.outside_;
+    CKYChart<double> & outside_right = workspace.outside_right_;
+    vector<vector<double> > & delta_unary = workspace.delta_unary_;
+
+    const Extent init_extent {
         num_words + 1, // narrow_right
         -1, // narrow_left
         -1, // wide_right
-        num_words + 1 })); // wide_left
+        num_words + 1 }; // wide_left
+    vector<vector<Extent> > & extent = workspace.extent_;
+    if (extent.size() < static_cast<size_t>(num_words + 1)) extent.resize(num_words + 1);
+    for (int i = 0; i <= num_words; ++i) {
+        extent[i].assign(num_tags, init_extent);
+    }
     
     // pre-parsing
 
@@ -189,7 +512,7 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
         //cout << "  init" << endl;
         setTerminalScores(allowed_tag, allowed_sub, inside, wid_list, tid_list, level, setting.partial);
         //cout << "  lexicon" << endl;
-        calculateInsideScores(allowed_tag, allowed_sub, inside, extent, level);
+        calculateInsideScores(allowed_tag, allowed_sub, inside, extent, delta_unary, level);
         //cout << "  inside" << endl;
 
         // check if all possible parses are pruned
@@ -200,7 +523,7 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
         }
         //cout << "  check" << endl;
 
-        calculateOutsideScores(allowed_tag, allowed_sub, inside, outside, extent, level);
+        calculateOutsideScores(allowed_tag, allowed_sub, inside, outside, outside_right, extent, delta_unary, level);
         //cout << "  outside" << endl;
         pruneCharts(allowed_tag, allowed_sub, inside, outside, level);
         //cout << "  prune" << endl;
@@ -210,22 +533,40 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
 
     // retrieve max-rule parse over allowed nodes
     
-    CKYTable<double> maxc_log_score(num_words, num_tags);
-    CKYTable<int> maxc_left(num_words, num_tags);
-    CKYTable<int> maxc_right(num_words, num_tags);
-    CKYTable<int> maxc_mid(num_words, num_tags);
-    CKYTable<int> maxc_child(num_words, num_tags);
+    CKYTable<double> & maxc_log_score = workspace.maxc_log_score_;
+    CKYTable<int> & maxc_left = workspace.maxc_left_;
+    CKYTable<int> & maxc_right = workspace.maxc_right_;
+    CKYTable<int> & maxc_mid = workspace.maxc_mid_;
+    CKYTable<int> & maxc_child = workspace.maxc_child_;
+    maxc_log_score.reset(num_words, num_tags);
+    maxc_left.reset(num_words, num_tags);
+    maxc_right.reset(num_words, num_tags);
+    maxc_mid.reset(num_words, num_tags);
+    maxc_child.reset(num_words, num_tags);
+    vector<vector<double> > & after_unary = workspace.after_unary_;
+    after_unary.resize(getNumSpanThreads());
+    for (vector<double> & after_unary_s : after_unary) after_unary_s.resize(num_tags);
+    vector<vector<double> > & marginal_buffer = workspace.marginal_;
+    marginal_buffer.resize(getNumSpanThreads());
+    for (vector<double> & marginal_buffer_s : marginal_buffer) {
+        marginal_buffer_s.resize(BitUtil::MAX_BITS * BitUtil::MAX_BITS + CompiledGrammar::ALIGNMENT / sizeof(double));
+    }
     const double log_normalizer = log(inside.at(0, num_words, root_tag)[0]);
     const double NEG_INFTY = -1e20;
     const Lexicon & fine_lexicon = getLexicon(final_level_to_try);
-    const Grammar & fine_grammar = getGrammar(final_level_to_try);
-    const ScalingFactor & fine_sf = getScalingFactor(final_level_to_try);
-
-    OOVLexiconSmoother smoother(fine_lexicon, *word_table_, smooth_unklex_);
+    const CompiledGrammar & fine_grammar = getCompiledGrammar(final_level_to_try);
+    const TerminalScoreTable & fine_terminal = *(terminal_score_[final_level_to_try]);
+    const ScoreKernel & kernel = getScoreKernel();
 
+    // cells of the same length are independent
     for (int len = 1; len <= num_words; ++len) {
-        for (int begin = 0; begin < num_words - len + 1; ++begin) {
+        forEachSpan(num_words - len + 1, [&](int begin, int slot) {
             int end = begin + len;
+            vector<double> & after_unary_s = after_unary[slot];
+
+            // rule scores summed over parent subtags weighted by outside scores:
+            //   [lsub]{rsub} (1 row per bit of marginal_mask)
+            double * marginal = alignBuffer(marginal_buffer[slot]);
 
             // inirialize arrays
             
@@ -244,12 +585,10 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
                     if (!allowed_tag.at(begin, end, ptag)) continue;
                     if (fine_lexicon.hasEntry(ptag)) continue; // semi-terminal
                     auto & binary_rules_p = fine_grammar.getBinaryRuleList(ptag);
-                    int num_psub = tag_set_->numSubtags(ptag, final_level_to_try);
 
-                    for (const BinaryRule * rule : binary_rules_p) {
-                        auto & score_list = rule->getScoreList();
-                        int ltag = rule->left();
-                        int rtag = rule->right();
+                    for (const CompiledBinaryRule & rule : binary_rules_p) {
+                        int ltag = rule.left;
+                        int rtag = rule.right;
 
                         int min1 = extent[begin][ltag].narrow_right;
                         if (min1 >= end) continue;
@@ -262,9 +601,9 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
                         int max = max1 < max2 ? max1 : max2;
                         if (min > max) continue;
 
-                        int num_lsub = tag_set_->numSubtags(ltag, final_level_to_try);
-                        int num_rsub = tag_set_->numSubtags(rtag, final_level_to_try);
                         double old_log_score = maxc_log_score.at(begin, end, ptag);
+                        bool marginalized = false;
+                        uint64_t marginal_mask = 0;
 
                         for (int mid = min; mid <= max; ++mid) {
                             if (!allowed_tag.at(begin, mid, ltag)) continue;
@@ -276,30 +615,36 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
                                 maxc_log_score.at(mid, end, rtag);
                             if (cur_log_score < old_log_score) continue;
 
-                            double rule_score = 0.0;
-
-                            for (int psub = 0; psub < num_psub; ++psub) {
-                                if (!allowed_sub.at(begin, end, ptag)[psub]) continue;
-                                auto & score_list_p = score_list[psub];
-                                if (score_list_p.empty()) continue;
-
-                                double po = outside.at(begin, end, ptag)[psub];
-
-                                for (int lsub = 0; lsub < num_lsub; ++lsub) {
-                                    if (!allowed_sub.at(begin, mid, ltag)[lsub]) continue;
-                                    auto & score_list_pl = score_list_p[lsub];
-                                    if (score_list_pl.empty()) continue;
-                                    double li = inside.at(begin, mid, ltag)[lsub];
-
-                                    for (int rsub = 0; rsub < num_rsub; ++rsub) {
-                                        if (!allowed_sub.at(mid, end, rtag)[rsub]) continue;
-                                        double ri = inside.at(mid, end, rtag)[rsub];
-                                        double beta = score_list_pl[rsub];
-                                        rule_score += po * li * ri * beta;
+                            // the sum over parent subtags does not depend on mid
+                            if (!marginalized) {
+                                uint64_t psubs = allowed_sub.at(begin, end, ptag) & rule.parent_mask;
+                                for (uint64_t psub_mask = psubs; psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                                    marginal_mask |= fine_grammar.getRowMask(rule, BitUtil::lowest(psub_mask));
+                                }
+                                fill(marginal, marginal + BitUtil::count(marginal_mask) * rule.stride, 0.0);
+
+                                for (uint64_t psub_mask = psubs; psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                                    int psub = BitUtil::lowest(psub_mask);
+                                    double po = outside.at(begin, end, ptag)[psub];
+                                    if (po == 0.0) continue;
+                                    const double * rows = fine_grammar.getRows(rule, psub);
+
+                                    for (uint64_t lsub_mask = fine_grammar.getRowMask(rule, psub); lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+                                        int lsub = BitUtil::lowest(lsub_mask);
+                                        double * marginal_l = marginal + BitUtil::count(marginal_mask & (BitUtil::bit(lsub) - 1)) * rule.stride;
+                                        kernel.accumulate(marginal_l, po, rows, rule.stride);
+                                        rows += rule.stride;
                                     }
                                 }
+
+                                marginalized = true;
                             }
 
+                            double rule_score = kernel.binaryInside(
+                                marginal, rule.stride, marginal_mask,
+                                inside.at(begin, mid, ltag), allowed_sub.at(begin, mid, ltag),
+                                inside.at(mid, end, rtag), allowed_sub.at(mid, end, rtag));
+
                             if (rule_score == 0) continue;
 
                             cur_log_score += log(rule_score) - log_normalizer;
@@ -317,23 +662,21 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
             } else {
                 int wid = wid_list[begin];
                 int tid = tid_list[begin];
-                double word_scaling = fine_sf.getLexiconScalingFactor(wid);
 
                 if (setting.partial && tid != -1) {
 
                     // if this condition is false, parsing maybe fails
-                    if (!allowed_tag.at(begin, end, tid)) continue;
+                    if (!allowed_tag.at(begin, end, tid)) return;
 
                     // process abstract grammar tags
-                    int num_sub = tag_set_->numSubtags(tid, final_level_to_try);
                     double rule_score = 0.0;
 
-                    for (int sub = 0; sub < num_sub; ++sub) {
-                        if (!allowed_sub.at(begin, end, tid)[sub]) continue;
+                    for (uint64_t sub_mask = allowed_sub.at(begin, end, tid); sub_mask; sub_mask = BitUtil::dropLowest(sub_mask)) {
+                        int sub = BitUtil::lowest(sub_mask);
                         rule_score += outside.at(begin, end, tid)[sub]; // rule_score += po;
                     }
 
-                    if (rule_score == 0.0) continue;
+                    if (rule_score == 0.0) return;
 
                     maxc_log_score.at(begin, end, tid) = log(rule_score) - log_normalizer;
 
@@ -341,60 +684,55 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
 
                     // process lexicon
 
-                    for (int tag = 0; tag < num_tags; ++tag) {
-                        if (!allowed_tag.at(begin, end, tag)) continue;
-                        if (!smoother.prepare(tag, wid)) continue;
-                        int num_sub = tag_set_->numSubtags(tag, final_level_to_try);
+                    fine_terminal.forEachTag(wid, [&](int tag, const double * scores, double factor) {
+                        if (!allowed_tag.at(begin, end, tag)) return;
+                        const double * outside_tag = outside.at(begin, end, tag);
                         double rule_score = 0.0;
 
-                        for (int sub = 0; sub < num_sub; ++sub) {
-                            if (!allowed_sub.at(begin, end, tag)[sub]) continue;
-                            double po = outside.at(begin, end, tag)[sub];
-                            double beta = word_scaling * smoother.getScore(sub);
+                        for (uint64_t sub_mask = allowed_sub.at(begin, end, tag); sub_mask; sub_mask = BitUtil::dropLowest(sub_mask)) {
+                            int sub = BitUtil::lowest(sub_mask);
+                            double po = outside_tag[sub];
+                            double beta = factor * scores[sub];
                             rule_score += po * beta;
                         }
 
-                        if (rule_score == 0.0) continue;
+                        if (rule_score == 0.0) return;
 
                         maxc_log_score.at(begin, end, tag) = log(rule_score) - log_normalizer;
-                    }
+                    });
                 }
             }
 
             // process unary rules
             
-            vector<double> after_unary(num_tags);
             for (int tag = 0; tag < num_tags; ++tag) {
-                after_unary[tag] = maxc_log_score.at(begin, end, tag);
+                after_unary_s[tag] = maxc_log_score.at(begin, end, tag);
             }
 
             for (int ptag = 0; ptag < num_tags; ++ptag) {
                 if (!allowed_tag.at(begin, end, ptag)) continue;
                 if (fine_lexicon.hasEntry(ptag)) continue; // semi-terminal
-                auto & unary_rules_p = fine_grammar.getUnaryRuleListByPC()[ptag];
-                int num_psub = tag_set_->numSubtags(ptag, final_level_to_try);
+                auto & unary_rules_p = fine_grammar.getUnaryRuleListByPC(ptag);
                 
-                for (const UnaryRule * rule : unary_rules_p) {
-                    int ctag = rule->child();
+                for (const CompiledUnaryRule & rule : unary_rules_p) {
+                    int ctag = rule.child;
                     if (!allowed_tag.at(begin, end, ctag)) continue;
                     if (len > 1 && fine_lexicon.hasEntry(ctag)) continue; // semi-terminal
                     if (ctag == ptag) continue;
-                    auto & score_list = rule->getScoreList();
-                    int num_csub = tag_set_->numSubtags(ctag, final_level_to_try);
 
                     double cur_log_score = maxc_log_score.at(begin, end, ctag);
-                    if (cur_log_score < after_unary[ptag]) continue;
+                    if (cur_log_score < after_unary_s[ptag]) continue;
 
                     double rule_score = 0.0;
 
-                    for (int psub = 0; psub < num_psub; ++psub) {
-                        if (!allowed_sub.at(begin, end, ptag)[psub]) continue;
-                        auto & score_list_p = score_list[psub];
-                        if (score_list_p.empty()) continue;
+                    for (uint64_t psub_mask = allowed_sub.at(begin, end, ptag); psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                        int psub = BitUtil::lowest(psub_mask);
+                        if (!BitUtil::test(rule.parent_mask, psub)) continue;
+                        const double * score_list_p = fine_grammar.getRow(rule, psub);
                         double po = outside.at(begin, end, ptag)[psub];
                         
-                        for (int csub = 0; csub < num_csub; ++csub) {
-                            if (!allowed_sub.at(begin, end, ctag)[csub]) continue;
+                        for (uint64_t csub_mask = allowed_sub.at(begin, end, ctag); csub_mask; csub_mask = BitUtil::dropLowest(csub_mask)) {
+                            int csub = BitUtil::lowest(csub_mask);
                             double ci = inside.at(begin, end, ctag)[csub];
                             double beta = score_list_p[csub];
                             rule_score += po * ci * beta;
@@ -405,15 +743,15 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
 
                     cur_log_score += log(rule_score) - log_normalizer;
 
-                    if (cur_log_score > after_unary[ptag]) {
-                        after_unary[ptag] = cur_log_score;
+                    if (cur_log_score > after_unary_s[ptag]) {
+                        after_unary_s[ptag] = cur_log_score;
                         maxc_child.at(begin, end, ptag) = ctag;
                     }
                 } // rule
             } // ptag
 
             for (int tag = 0; tag < num_tags; ++tag) {
-                maxc_log_score.at(begin, end, tag) = after_unary[tag];
+                maxc_log_score.at(begin, end, tag) = after_unary_s[tag];
             }
 
             /*
@@ -436,7 +774,7 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
                 }
             }
             */
-        } // begin
+        }); // begin
     } // len
 
     // build max-rule parse tree
@@ -532,6 +870,13 @@ ParserResult LAPCFGParser::generateMaxRuleOneBestParse(
     }
 }
 
+const Grammar & LAPCFGParser::getGrammar(int level) const {
+    if (grammar_.empty()) {
+        throw runtime_error("LAPCFGParser::getGrammar(): grammars are not loaded from binary models");
+    }
+    return *(grammar_[level]);
+}
+
 void LAPCFGParser::setFineLevel(int value) {
     int depth = tag_set_->getDepth();
     if (value < 0 || value >= depth) {
@@ -539,6 +884,13 @@ void LAPCFGParser::setFineLevel(int value) {
     } else {
         fine_level_ = value;
     }
+    model_ready_ = false;
+
+    // expected counts are used only by scaling factors of levels to parse.
+    // (they are computed again if finer levels are required later)
+    for (int level = fine_level_ + 1; level < depth; ++level) {
+        expected_count_[level].reset();
+    }
 }
 
 void LAPCFGParser::setPruningThreshold(double value) {
@@ -547,6 +899,34 @@ void LAPCFGParser::setPruningThreshold(double value) {
     prune_threshold_ = value;
 }
 
+void LAPCFGParser::setScoreKernel(shared_ptr<ScoreKernel> value) {
+    if (!value)
+        throw runtime_error("LAPCFGParser::setScoreKernel(): invalid value");
+    score_kernel_ = value;
+}
+
+void LAPCFGParser::setNumSpanThreads(int value) {
+    if (value < 0)
+        throw runtime_error("LAPCFGParser::setNumSpanThreads(): invalid value");
+    if (value == 0) {
+        value = thread::hardware_concurrency();
+        if (value <= 0) value = 1;
+    }
+    if (value == getNumSpanThreads()) return;
+    span_pool_ = (value > 1) ? make_shared<ThreadPool>(value) : shared_ptr<ThreadPool>();
+}
+
+template <typename Func>
+void LAPCFGParser::forEachSpan(int num_spans, const Func & func) const {
+    if (!span_pool_ || num_spans <= 1) {
+        for (int begin = 0; begin < num_spans; ++begin) {
+            func(begin, 0);
+        }
+        return;
+    }
+    span_pool_->parallelFor(num_spans, func);
+}
+
 void LAPCFGParser::setUNKLexiconSmoothing(double value) {
     if (value < 0.0 || value > 1.0)
         throw runtime_error("LAPCFGParser::setUNKLexiconSmoothing(): invalid value");
@@ -577,34 +957,66 @@ shared_ptr<Tree<string> > LAPCFGParser::getDefaultParse(const vector<string> & s
     }
 }
 
-vector<int> LAPCFGParser::makeWordIdList(const vector<string> & sentence) const {
+void LAPCFGParser::makeWordIdList(
+    const vector<string> & sentence,
+    ParseWorkspace & workspace) const {
+
+    // maximum number of memoized signatures for each location class
+    const size_t MAX_SIGNATURE_CACHE = 1 << 16;
+
     const int num_words = sentence.size();
-    vector<int> wid_list(num_words);
+    const bool trace = Tracer::getTraceLevel() >= 2; // avoid formatting unused texts
+    vector<int> & wid_list = workspace.wid_list_;
+    wid_list.resize(num_words);
+
+    auto & cache = workspace.signature_cache_;
+    if (workspace.signature_owner_ != serial_) {
+        // word IDs of other parsers are not usable
+        cache.clear();
+        workspace.signature_owner_ = serial_;
+    }
     
-    Tracer::print(2, "  WID:");
+    if (trace) Tracer::print(2, "  WID:");
 
     for (int i = 0; i < num_words; ++i) {
         int wid = word_table_->getId(sentence[i]);
         if (wid == -1) {
-            // estimate signature
-            string signature = sig_est_->getSignature(sentence, i);
-            wid = word_table_->getId(signature);
-            Tracer::print(2, (boost::format(" %d(%s)") % wid % signature).str());
+            // estimate signature, or reuse the last result of the same word
+            int loc_class = trace ? -1 : sig_est_->getLocationClass(sentence, i);
+            if (loc_class >= 0) {
+                if (cache.size() <= static_cast<size_t>(loc_class)) cache.resize(loc_class + 1);
+                auto & cache_c = cache[loc_class];
+                auto it = cache_c.find(sentence[i]);
+                if (it != cache_c.end()) {
+                    wid = it->second;
+                } else {
+                    wid = word_table_->getId(sig_est_->getSignature(sentence, i));
+                    if (cache_c.size() >= MAX_SIGNATURE_CACHE) cache_c.clear();
+                    cache_c.insert(make_pair(sentence[i], wid));
+                }
+            } else {
+                string signature = sig_est_->getSignature(sentence, i);
+                wid = word_table_->getId(signature);
+                if (trace) Tracer::print(2, (boost::format(" %d(%s)") % wid % signature).str());
+            }
         } else {
-            Tracer::print(2, (boost::format(" %d") % wid).str());
+            if (trace) Tracer::print(2, (boost::format(" %d") % wid).str());
         }
         wid_list[i] = wid;
     }
     
-    Tracer::println(2);
-    return wid_list;
+    if (trace) Tracer::println(2);
 }
 
-vector<int> LAPCFGParser::makeTagIdList(const vector<string> & sentence) const {
+void LAPCFGParser::makeTagIdList(
+    const vector<string> & sentence,
+    vector<int> & tid_list) const {
+
     const int num_words = sentence.size();
-    vector<int> tid_list(num_words);
+    const bool trace = Tracer::getTraceLevel() >= 2; // avoid formatting unused texts
+    tid_list.resize(num_words);
 
-    Tracer::print(2, "  TID:");
+    if (trace) Tracer::print(2, "  TID:");
 
     for (int i = 0; i < num_words; ++i) {
         const string & word = sentence[i];
@@ -613,31 +1025,34 @@ vector<int> LAPCFGParser::makeTagIdList(const vector<string> & sentence) const {
         if (word.size() >= 2 && word[0] == '[' && word[word.size() - 1] == ']') {
             const string name = word.substr(1, word.size() - 2);
             tid = tag_set_->getTagId(name);
-            Tracer::print(2, (boost::format(" %d(%s)") % tid % name).str());
+            if (trace) Tracer::print(2, (boost::format(" %d(%s)") % tid % name).str());
         } else {
-            Tracer::print(2, (boost::format(" %d") % tid).str());
+            if (trace) Tracer::print(2, (boost::format(" %d") % tid).str());
         }
         tid_list[i] = tid;
     }
 
-    Tracer::println(2);
-    return tid_list;
+    if (trace) Tracer::println(2);
 }
 
 void LAPCFGParser::doM1Preparse(
     CKYTable<bool> & allowed_tag,
     const std::vector<int> & wid_list,
     const std::vector<int> & tid_list,
+    CKYTable<double> & inside,
+    CKYTable<double> & outside,
     bool partial) const {
 
     const int num_words = wid_list.size();
     const int num_tags = tag_set_->numTags();
     const int root_tag = tag_set_->getTagId("ROOT");
     const Lexicon & g0_lexicon = getLexicon(0);
-    CKYTable<double> inside(num_words, num_tags);
-    CKYTable<double> outside(num_words, num_tags);
-    M1OOVLexiconSmoother smoother(*m1_lexicon_, *word_table_, smooth_unklex_);
+    inside.reset(num_words, num_tags);
+    outside.reset(num_words, num_tags);
+    const M1OOVLexiconSmoother & smoother = *m1_smoother_;
     const double binary_scaling = 1.0 / m1_grammar_->getBinaryScore(root_tag, root_tag);
+    vector<int> live_mid; // {mid} with nonzero left inside scores
+    live_mid.reserve(num_words);
 
     // initialize
 
@@ -677,17 +1092,28 @@ void LAPCFGParser::doM1Preparse(
             int end = begin + len;
 
             // binary
+            // (only nonzero rules and nonzero left cells are visited, the order of
+            // remaining terms is same as the dense loop)
             if (len > 1) {
                 double sum = 0.0;
 
                 for (int ltag = 0; ltag < num_tags; ++ltag) {
                     if (ltag != root_tag && !g0_lexicon.hasEntry(ltag)) continue;
+                    auto & entries = m1_grammar_->getBinaryEntryList(ltag);
+                    if (entries.empty()) continue;
+
+                    live_mid.clear();
+                    for (int mid = begin + 1; mid < end; ++mid) {
+                        if (inside.at(begin, mid, ltag) != 0.0) live_mid.push_back(mid);
+                    }
+                    if (live_mid.empty()) continue;
 
-                    for (int rtag = 0; rtag < num_tags; ++rtag) {
+                    for (auto & ent : entries) {
+                        int rtag = ent.right;
                         if (rtag != root_tag && !g0_lexicon.hasEntry(rtag)) continue;
-                        double rule_score = binary_scaling * m1_grammar_->getBinaryScore(ltag, rtag);
+                        double rule_score = binary_scaling * ent.score;
 
-                        for (int mid = begin + 1; mid < end; ++mid) {
+                        for (int mid : live_mid) {
                             double left_score = inside.at(begin, mid, ltag);
                             double right_score = inside.at(mid, end, rtag);
                             sum += rule_score * left_score * right_score;
@@ -725,19 +1151,30 @@ void LAPCFGParser::doM1Preparse(
             }
 
             // binary
-            if (len > 1) {
-                double parent_score = binary_scaling * outside.at(begin, end, root_tag);
-
+            // (children with zero inside scores are never allowed, so their
+            // outside scores are not accumulated)
+            double parent_score = binary_scaling * outside.at(begin, end, root_tag);
+            if (len > 1 && parent_score != 0.0) {
                 for (int ltag = 0; ltag < num_tags; ++ltag) {
                     if (ltag != root_tag && !g0_lexicon.hasEntry(ltag)) continue;
+                    auto & entries = m1_grammar_->getBinaryEntryList(ltag);
+                    if (entries.empty()) continue;
 
-                    for (int rtag = 0; rtag < num_tags; ++rtag) {
+                    live_mid.clear();
+                    for (int mid = begin + 1; mid < end; ++mid) {
+                        if (inside.at(begin, mid, ltag) != 0.0) live_mid.push_back(mid);
+                    }
+                    if (live_mid.empty()) continue;
+
+                    for (auto & ent : entries) {
+                        int rtag = ent.right;
                         if (rtag != root_tag && !g0_lexicon.hasEntry(rtag)) continue;
-                        double rule_score = parent_score * m1_grammar_->getBinaryScore(ltag, rtag);
+                        double rule_score = parent_score * ent.score;
 
-                        for (int mid = begin + 1; mid < end; ++mid) {
+                        for (int mid : live_mid) {
                             double left_score = inside.at(begin, mid, ltag);
                             double right_score = inside.at(mid, end, rtag);
+                            if (right_score == 0.0) continue;
                             outside.at(begin, mid, ltag) += rule_score * right_score;
                             outside.at(mid, end, rtag) += rule_score * left_score;
                         }
@@ -774,57 +1211,42 @@ void LAPCFGParser::doM1Preparse(
 
 void LAPCFGParser::initializeCharts(
     CKYTable<bool> & allowed_tag,
-    CKYTable<vector<bool> > & allowed_sub,
-    CKYTable<vector<double> > & inside,
-    CKYTable<vector<double> > & outside,
+    CKYTable<uint64_t> & allowed_sub,
+    CKYChart<double> & inside,
+    CKYChart<double> & outside,
     vector<vector<Extent> > & extent,
     int cur_level) const {
 
     const int num_words = allowed_tag.numWords();
     const int num_tags = allowed_tag.numTags();
-   
-    unique_ptr<Mapping> mapping(nullptr);
-    if (cur_level > 0) {
-        mapping.reset(new Mapping(*tag_set_, cur_level - 1, cur_level));
-    }
+    const vector<int> & offsets = tag_set_->getSubtagOffsets(cur_level);
+    const Mapping * mapping = mapping_[cur_level].get();
+
+    // charts are reused with the layout of current level
+    inside.reset(num_words, offsets, 0.0);
+    outside.reset(num_words, offsets, 0.0);
 
     for (int begin = 0; begin < num_words; ++begin) {
         for (int end = begin + 1; end <= num_words; ++end) {
             for (int tag = 0; tag < num_tags; ++tag) {
                 if (cur_level > 0) {
-                    if (allowed_tag.at(begin, end, tag)) {
-                        // initialize subtag constraints
-                        int num_subtags_fine = tag_set_->numSubtags(tag, cur_level);
-                        inside.at(begin, end, tag).assign(num_subtags_fine, 0.0);
-                        outside.at(begin, end, tag).assign(num_subtags_fine, 0.0);
-                        int num_subtags_coarse = tag_set_->numSubtags(tag, cur_level - 1);
-                        vector<bool> & allowed_sub_fine = allowed_sub.at(begin, end, tag);
-                        vector<bool> allowed_sub_coarse = allowed_sub_fine;
-                        allowed_sub_fine.assign(num_subtags_fine, false);
-                        
-                        // do coarse-to-fine mapping
-                        for (int subtag_coarse = 0; subtag_coarse < num_subtags_coarse; ++subtag_coarse) {
-                            if (!allowed_sub_coarse[subtag_coarse]) continue;
-                            for (int subtag_fine : mapping->getCoarseToFineMaps(tag, subtag_coarse)) {
-                                allowed_sub_fine[subtag_fine] = true;
-                            }
-                        }
-                    } else {
-                        // delete unnecessary data to suppress memory
-                        inside.at(begin, end, tag).clear();
-                        outside.at(begin, end, tag).clear();
+                    if (!allowed_tag.at(begin, end, tag)) continue;
+
+                    // do coarse-to-fine mapping of subtag constraints
+                    uint64_t & allowed_sub_tag = allowed_sub.at(begin, end, tag);
+                    uint64_t allowed_sub_fine = 0;
+                    for (uint64_t coarse_mask = allowed_sub_tag; coarse_mask; coarse_mask = BitUtil::dropLowest(coarse_mask)) {
+                        allowed_sub_fine |= mapping->getCoarseToFineMask(tag, BitUtil::lowest(coarse_mask));
                     }
+                    allowed_sub_tag = allowed_sub_fine;
                 } else {
                     // only 1 subtag is possible for the first time
-                    inside.at(begin, end, tag).assign(1, 0.0);
-                    outside.at(begin, end, tag).assign(1, 0.0);
-                    
                     if (do_m1_preparse_) {
                         // already set at doM1Preparse()
-                        allowed_sub.at(begin, end, tag).assign(1, allowed_tag.at(begin, end, tag));
+                        allowed_sub.at(begin, end, tag) = allowed_tag.at(begin, end, tag) ? 1 : 0;
                     } else {
                         allowed_tag.at(begin, end, tag) = true;
-                        allowed_sub.at(begin, end, tag).assign(1, true);
+                        allowed_sub.at(begin, end, tag) = 1;
                     }
                 }
             }
@@ -842,18 +1264,15 @@ void LAPCFGParser::initializeCharts(
 
 void LAPCFGParser::setTerminalScores(
     const CKYTable<bool> & allowed_tag,
-    const CKYTable<vector<bool> > & allowed_sub,
-    CKYTable<vector<double> > & inside,
+    const CKYTable<uint64_t> & allowed_sub,
+    CKYChart<double> & inside,
     const vector<int> & wid_list,
     const vector<int> & tid_list,
     int cur_level,
     bool partial) const {
 
     const int num_words = allowed_tag.numWords();
-    const int num_tags = allowed_tag.numTags();
-    const Lexicon & cur_lexicon = getLexicon(cur_level);
-    const ScalingFactor & cur_sf = getScalingFactor(cur_level);
-    OOVLexiconSmoother smoother(cur_lexicon, *word_table_, smooth_unklex_);
+    const TerminalScoreTable & cur_terminal = *(terminal_score_[cur_level]);
 
     for (int begin = 0; begin < num_words; ++begin) {
         int end = begin + 1;
@@ -866,51 +1285,54 @@ void LAPCFGParser::setTerminalScores(
             if (!allowed_tag.at(begin, end, tid)) continue;
 
             // set 1.0 into specific abstract tag
-            int num_sub = tag_set_->numSubtags(tid, cur_level);
-            for (int sub = 0; sub < num_sub; ++sub) {
-                if (!allowed_sub.at(begin, end, tid)[sub]) continue;
+            for (uint64_t sub_mask = allowed_sub.at(begin, end, tid); sub_mask; sub_mask = BitUtil::dropLowest(sub_mask)) {
+                int sub = BitUtil::lowest(sub_mask);
                 inside.at(begin, end, tid)[sub] = 1.0;
             }
 
         } else {
             
             // process lexicon
-            double word_scaling = cur_sf.getLexiconScalingFactor(wid);
-
-            for (int tag = 0; tag < num_tags; ++tag) {
-                if (!allowed_tag.at(begin, end, tag)) continue;
-                if (!smoother.prepare(tag, wid)) continue;
-                int num_sub = tag_set_->numSubtags(tag, cur_level);
+            cur_terminal.forEachTag(wid, [&](int tag, const double * scores, double factor) {
+                if (!allowed_tag.at(begin, end, tag)) return;
+                double * inside_tag = inside.at(begin, end, tag);
             
-                for (int sub = 0; sub < num_sub; ++sub) {
-                    if (!allowed_sub.at(begin, end, tag)[sub]) continue;
-                    inside.at(begin, end, tag)[sub] = word_scaling * smoother.getScore(sub);
-                
-                    //cerr << begin << "(" << wid_list[begin] << ")->"
-                    //    << tag_set_->getTagName(tag) << "[" << sub << "] = "
-                    //    << inside.at(begin, end, tag)[sub] << endl;
+                for (uint64_t sub_mask = allowed_sub.at(begin, end, tag); sub_mask; sub_mask = BitUtil::dropLowest(sub_mask)) {
+                    int sub = BitUtil::lowest(sub_mask);
+                    inside_tag[sub] = factor * scores[sub];
                 }
-            }
+            });
         }
     }
 }
 
 void LAPCFGParser::calculateInsideScores(
     const CKYTable<bool> & allowed_tag,
-    const CKYTable<vector<bool> > & allowed_sub,
-    CKYTable<vector<double> > & inside,
+    const CKYTable<uint64_t> & allowed_sub,
+    CKYChart<double> & inside,
     vector<vector<Extent> > & extent,
+    vector<vector<double> > & delta_unary,
     int cur_level) const {
 
     const int num_words = allowed_tag.numWords();
     const int num_tags = allowed_tag.numTags();
+    const vector<int> & offsets = tag_set_->getSubtagOffsets(cur_level);
     const Lexicon & cur_lexicon = getLexicon(cur_level);
-    const Grammar & cur_grammar = getGrammar(cur_level);
+    const CompiledGrammar & cur_grammar = getCompiledGrammar(cur_level);
     const double sf = getScalingFactor(cur_level).getGrammarScalingFactor();
+    const ScoreKernel & kernel = getScoreKernel();
+
+    // [slot][subtag offset]: only ranges of allowed tags are cleared at each span
+    delta_unary.resize(getNumSpanThreads());
+    for (vector<double> & delta_unary_s : delta_unary) delta_unary_s.resize(offsets.back());
 
+    // cells of the same length are independent. a cell updates only right bounds of
+    // extent[begin] and left bounds of extent[end], which other cells of the same
+    // length never read or write.
     for (int len = 1; len <= num_words; ++len) {
-        for (int begin = 0; begin < num_words - len + 1; ++begin) {
+        forEachSpan(num_words - len + 1, [&](int begin, int slot) {
             int end = begin + len;
+            vector<double> & delta_unary_s = delta_unary[slot];
 
             // process binary rules
 
@@ -919,16 +1341,15 @@ void LAPCFGParser::calculateInsideScores(
                     if (!allowed_tag.at(begin, end, ptag)) continue;
                     if (cur_lexicon.hasEntry(ptag)) continue; // semi-terminal
                     auto & binary_rules_p = cur_grammar.getBinaryRuleList(ptag);
-                    int num_psub = tag_set_->numSubtags(ptag, cur_level);
                     bool changed = false;
                 
-                    for (int psub = 0; psub < num_psub; ++psub) {
-                        if (!allowed_sub.at(begin, end, ptag)[psub]) continue;
+                    for (uint64_t psub_mask = allowed_sub.at(begin, end, ptag); psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                        int psub = BitUtil::lowest(psub_mask);
                         double sum = 0.0;
 
-                        for (const BinaryRule * rule : binary_rules_p) {
-                            int ltag = rule->left();
-                            int rtag = rule->right();
+                        for (const CompiledBinaryRule & rule : binary_rules_p) {
+                            int ltag = rule.left;
+                            int rtag = rule.right;
 
                             int min1 = extent[begin][ltag].narrow_right;
                             if (min1 >= end) continue;
@@ -941,10 +1362,9 @@ void LAPCFGParser::calculateInsideScores(
                             int max = max1 < max2 ? max1 : max2;
                             if (min > max) continue;
 
-                            int num_lsub = tag_set_->numSubtags(ltag, cur_level);
-                            int num_rsub = tag_set_->numSubtags(rtag, cur_level);
-                            auto & score_list_p = rule->getScoreList()[psub];
-                            if (score_list_p.empty()) continue;
+                            if (!BitUtil::test(rule.parent_mask, psub)) continue;
+                            uint64_t row_mask = cur_grammar.getRowMask(rule, psub);
+                            const double * rows = cur_grammar.getRows(rule, psub);
                             
                             for (int mid = min; mid <= max; ++mid) {
                                 if (!allowed_tag.at(begin, mid, ltag)) continue;
@@ -952,29 +1372,14 @@ void LAPCFGParser::calculateInsideScores(
                                 if (mid - begin > 1 && cur_lexicon.hasEntry(ltag)) continue; // semi-terminal
                                 if (end - mid > 1 && cur_lexicon.hasEntry(rtag)) continue; // semi-terminal
 
-                                auto & allowed_sub_lsubs = allowed_sub.at(begin, mid, ltag);
-                                auto & allowed_sub_rsubs = allowed_sub.at(mid, end, rtag);
-                                auto & inside_lsubs = inside.at(begin, mid, ltag);
-                                auto & inside_rsubs = inside.at(mid, end, rtag);
-                        
-                                for (int lsub = 0; lsub < num_lsub; ++lsub) {
-                                    if (!allowed_sub_lsubs[lsub]) continue;
-                                    auto & score_list_pl = score_list_p[lsub];
-                                    if (score_list_pl.empty()) continue;
-                                    double left_score = inside_lsubs[lsub];
-                                    if (left_score == 0.0) continue;
-                    
-                                    for (int rsub = 0; rsub < num_rsub; ++rsub) {
-                                        if (!allowed_sub_rsubs[rsub]) continue;
-                                        double rule_score = score_list_pl[rsub];
-                                        if (rule_score == 0.0) continue;
-                                        double right_score = inside_rsubs[rsub];
-                                        if (right_score == 0.0) continue;
-                            
-                                        sum += sf * rule_score * left_score * right_score;
-                                        changed = true;
-                                    }
-                                }
+                                double score = kernel.binaryInside(
+                                    rows, rule.stride, row_mask,
+                                    inside.at(begin, mid, ltag), allowed_sub.at(begin, mid, ltag),
+                                    inside.at(mid, end, rtag), allowed_sub.at(mid, end, rtag));
+                                if (score == 0.0) continue;
+
+                                sum += sf * score;
+                                changed = true;
                             }
                         }
 
@@ -1006,30 +1411,28 @@ void LAPCFGParser::calculateInsideScores(
 
             // process unary rules
 
-            vector<vector<double> > delta_unary(num_tags);
-
             for (int ptag = 0; ptag < num_tags; ++ptag) {
                 if (!allowed_tag.at(begin, end, ptag)) continue;
                 if (cur_lexicon.hasEntry(ptag)) continue; // semi-terminal
-                auto & unary_rules_p = cur_grammar.getUnaryRuleListByPC()[ptag];
+                auto & unary_rules_p = cur_grammar.getUnaryRuleListByPC(ptag);
                 int num_psub = tag_set_->numSubtags(ptag, cur_level);
-                delta_unary[ptag].assign(num_psub, 0.0);
+                double * delta_unary_p = delta_unary_s.data() + offsets[ptag];
+                fill(delta_unary_p, delta_unary_p + num_psub, 0.0);
                 
-                for (int psub = 0; psub < num_psub; ++psub) {
-                    if (!allowed_sub.at(begin, end, ptag)[psub]) continue;
+                for (uint64_t psub_mask = allowed_sub.at(begin, end, ptag); psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                    int psub = BitUtil::lowest(psub_mask);
 
-                    for (const UnaryRule * rule : unary_rules_p) {
-                        int ctag = rule->child();
+                    for (const CompiledUnaryRule & rule : unary_rules_p) {
+                        int ctag = rule.child;
                         if (!allowed_tag.at(begin, end, ctag)) continue;
                         if (len > 1 && cur_lexicon.hasEntry(ctag)) continue; // semi-terminal
                         if (ctag == ptag) continue;
-                        int num_csub = tag_set_->numSubtags(ctag, cur_level);
-                        auto & score_list_p = rule->getScoreList()[psub];
-                        if (score_list_p.empty()) continue;
+                        if (!BitUtil::test(rule.parent_mask, psub)) continue;
+                        const double * score_list_p = cur_grammar.getRow(rule, psub);
                         
-                        for (int csub = 0; csub < num_csub; ++csub) {
-                            if (!allowed_sub.at(begin, end, ctag)[csub]) continue;
-                            delta_unary[ptag][psub] +=
+                        for (uint64_t csub_mask = allowed_sub.at(begin, end, ctag); csub_mask; csub_mask = BitUtil::dropLowest(csub_mask)) {
+                            int csub = BitUtil::lowest(csub_mask);
+                            delta_unary_p[psub] +=
                                 score_list_p[csub] *
                                 inside.at(begin, end, ctag)[csub];
                         }
@@ -1040,10 +1443,9 @@ void LAPCFGParser::calculateInsideScores(
             for (int ptag = 0; ptag < num_tags; ++ptag) {
                 if (!allowed_tag.at(begin, end, ptag)) continue;
                 if (cur_lexicon.hasEntry(ptag)) continue; // semi-terminal
-                int num_psub = tag_set_->numSubtags(ptag, cur_level);
-                for (int psub = 0; psub < num_psub; ++psub) {
-                    if (!allowed_sub.at(begin, end, ptag)[psub]) continue;
-                    inside.at(begin, end, ptag)[psub] += delta_unary[ptag][psub];
+                for (uint64_t psub_mask = allowed_sub.at(begin, end, ptag); psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                    int psub = BitUtil::lowest(psub_mask);
+                    inside.at(begin, end, ptag)[psub] += delta_unary_s[offsets[ptag] + psub];
                 }
             }
 
@@ -1066,57 +1468,81 @@ void LAPCFGParser::calculateInsideScores(
             fprintf(stderr, "best[%d:%d] ... %s[%d] = %e\n",
                 begin, end, tag_set_->getTagName(best_ptag).c_str(), best_psub, best_score);
             */
-        } // begin
+        }); // begin
     } // len
 }
 
 void LAPCFGParser::calculateOutsideScores(
     const CKYTable<bool> & allowed_tag,
-    const CKYTable<vector<bool> > & allowed_sub,
-    const CKYTable<vector<double> > & inside,
-    CKYTable<vector<double> > & outside,
+    const CKYTable<uint64_t> & allowed_sub,
+    const CKYChart<double> & inside,
+    CKYChart<double> & outside,
+    CKYChart<double> & outside_right,
     vector<vector<Extent> > & extent,
+    vector<vector<double> > & delta_unary,
     int cur_level) const {
 
     const int num_words = allowed_tag.numWords();
     const int num_tags = allowed_tag.numTags();
+    const vector<int> & offsets = tag_set_->getSubtagOffsets(cur_level);
     const int root_tag = tag_set_->getTagId("ROOT");
     const Lexicon & cur_lexicon = getLexicon(cur_level);
-    const Grammar & cur_grammar = getGrammar(cur_level);
+    const CompiledGrammar & cur_grammar = getCompiledGrammar(cur_level);
     const double sf = getScalingFactor(cur_level).getGrammarScalingFactor();
+    const ScoreKernel & kernel = getScoreKernel();
+
+    // [slot][subtag offset]: only ranges of allowed tags are cleared at each span
+    delta_unary.resize(getNumSpanThreads());
+    for (vector<double> & delta_unary_s : delta_unary) delta_unary_s.resize(offsets.back());
+
+    // a child span receives scores from 2 cells of the same length, as the left child
+    // of one and the right child of the other. scores as a right child are added into
+    // outside_right, so cells of the same length never write the same value. they are
+    // merged into outside just before the span is processed as a parent, in the same
+    // order regardless of the number of span threads.
+    outside_right.reset(num_words, offsets, 0.0);
 
     outside.at(0, num_words, root_tag)[0] = 1.0;
 
     for (int len = num_words; len >= 1; --len) {
-        for (int begin = 0; begin < num_words - len + 1; ++begin) {
+        forEachSpan(num_words - len + 1, [&](int begin, int slot) {
             int end = begin + len;
+            vector<double> & delta_unary_s = delta_unary[slot];
 
-            // process unary rules
+            // merge scores as a right child
 
-            vector<vector<double> > delta_unary(num_tags);
+            for (int tag = 0; tag < num_tags; ++tag) {
+                if (!allowed_tag.at(begin, end, tag)) continue;
+                double * outside_tag = outside.at(begin, end, tag);
+                const double * outside_right_tag = outside_right.at(begin, end, tag);
+                for (int sub = 0; sub < offsets[tag + 1] - offsets[tag]; ++sub) {
+                    outside_tag[sub] += outside_right_tag[sub];
+                }
+            }
+
+            // process unary rules
 
             for (int ctag = 0; ctag < num_tags; ++ctag) {
                 if (!allowed_tag.at(begin, end, ctag)) continue;
                 if (len > 1 && cur_lexicon.hasEntry(ctag)) continue; // semi-terminal
-                auto & unary_rules_c = cur_grammar.getUnaryRuleListByCP()[ctag];
+                auto & unary_rules_c = cur_grammar.getUnaryRuleListByCP(ctag);
                 int num_csub = tag_set_->numSubtags(ctag, cur_level);
-                delta_unary[ctag].assign(num_csub, 0.0);
+                double * delta_unary_c = delta_unary_s.data() + offsets[ctag];
+                fill(delta_unary_c, delta_unary_c + num_csub, 0.0);
 
-                for (int csub = 0; csub < num_csub; ++csub) {
-                    if (!allowed_sub.at(begin, end, ctag)[csub]) continue;
-                    
-                    for (const UnaryRule * rule : unary_rules_c) {
-                        int ptag = rule->parent();
+                for (uint64_t csub_mask = allowed_sub.at(begin, end, ctag); csub_mask; csub_mask = BitUtil::dropLowest(csub_mask)) {
+                    int csub = BitUtil::lowest(csub_mask);
+            
+                    for (const CompiledUnaryRule & rule : unary_rules_c) {
+                        int ptag = rule.parent;
                         if (!allowed_tag.at(begin, end, ptag)) continue;
                         if (ptag == ctag) continue;
-                        int num_psub = tag_set_->numSubtags(ptag, cur_level);
-                        auto & score_list = rule->getScoreList();
-
-                        for (int psub = 0; psub < num_psub; ++psub) {
-                            if (!allowed_sub.at(begin, end, ptag)[psub]) continue;
-                            auto & score_list_p = score_list[psub];
-                            if (score_list_p.empty()) continue;
-                            delta_unary[ctag][csub] +=
+
+                        for (uint64_t psub_mask = allowed_sub.at(begin, end, ptag); psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                            int psub = BitUtil::lowest(psub_mask);
+                            if (!BitUtil::test(rule.parent_mask, psub)) continue;
+                            const double * score_list_p = cur_grammar.getRow(rule, psub);
+                            delta_unary_c[csub] +=
                                 score_list_p[csub] *
                                 outside.at(begin, end, ptag)[psub];
                         }
@@ -1129,7 +1555,7 @@ void LAPCFGParser::calculateOutsideScores(
                 if (len > 1 && cur_lexicon.hasEntry(ctag)) continue; // semi-terminal
                 int num_csub = tag_set_->numSubtags(ctag, cur_level);
                 for (int csub = 0; csub < num_csub; ++csub) {
-                    outside.at(begin, end, ctag)[csub] += delta_unary[ctag][csub];
+                    outside.at(begin, end, ctag)[csub] += delta_unary_s[offsets[ctag] + csub];
                 }
             }
 
@@ -1140,16 +1566,15 @@ void LAPCFGParser::calculateOutsideScores(
                     if (!allowed_tag.at(begin, end, ptag)) continue;
                     if (cur_lexicon.hasEntry(ptag)) continue; // semi-terminal
                     auto & binary_rules_p = cur_grammar.getBinaryRuleList(ptag);
-                    int num_psub = tag_set_->numSubtags(ptag, cur_level);
 
-                    for (int psub = 0; psub < num_psub; ++psub) {
-                        if (!allowed_sub.at(begin, end, ptag)[psub]) continue;
+                    for (uint64_t psub_mask = allowed_sub.at(begin, end, ptag); psub_mask; psub_mask = BitUtil::dropLowest(psub_mask)) {
+                        int psub = BitUtil::lowest(psub_mask);
                         double parent_score = sf * outside.at(begin, end, ptag)[psub];
                         if (parent_score == 0.0) continue;
 
-                        for (const BinaryRule * rule : binary_rules_p) {
-                            int ltag = rule->left();
-                            int rtag = rule->right();
+                        for (const CompiledBinaryRule & rule : binary_rules_p) {
+                            int ltag = rule.left;
+                            int rtag = rule.right;
 
                             int min1 = extent[begin][ltag].narrow_right;
                             if (min1 >= end) continue;
@@ -1162,10 +1587,9 @@ void LAPCFGParser::calculateOutsideScores(
                             int max = max1 < max2 ? max1 : max2;
                             if (min > max) continue;
 
-                            int num_lsub = tag_set_->numSubtags(ltag, cur_level);
-                            int num_rsub = tag_set_->numSubtags(rtag, cur_level);
-                            auto & score_list_p = rule->getScoreList()[psub];
-                            if (score_list_p.empty()) continue;
+                            if (!BitUtil::test(rule.parent_mask, psub)) continue;
+                            uint64_t row_mask = cur_grammar.getRowMask(rule, psub);
+                            const double * rows = cur_grammar.getRows(rule, psub);
 
                             for (int mid = min; mid <= max; ++mid) {
                                 if (!allowed_tag.at(begin, mid, ltag)) continue;
@@ -1173,57 +1597,26 @@ void LAPCFGParser::calculateOutsideScores(
                                 if (mid - begin > 1 && cur_lexicon.hasEntry(ltag)) continue; // semi-terminal
                                 if (end - mid > 1 && cur_lexicon.hasEntry(rtag)) continue; // semi-terminal
 
-                                auto & allowed_sub_lsubs = allowed_sub.at(begin, mid, ltag);
-                                auto & allowed_sub_rsubs = allowed_sub.at(mid, end, rtag);
-                                auto & inside_lsubs = inside.at(begin, mid, ltag);
-                                auto & inside_rsubs = inside.at(mid, end, rtag);
-                                auto & outside_lsubs = outside.at(begin, mid, ltag);
-                                auto & outside_rsubs = outside.at(mid, end, rtag);
-
-                                for (int lsub = 0; lsub < num_lsub; ++lsub) {
-                                    if (!allowed_sub_lsubs[lsub]) continue;
-                                    auto & score_list_pl = score_list_p[lsub];
-                                    if (score_list_pl.empty()) continue;
-                                    double left_score = inside_lsubs[lsub];
-                                    if (left_score == 0.0) continue;
-
-                                    for (int rsub = 0; rsub < num_rsub; ++rsub) {
-                                        if (!allowed_sub_rsubs[rsub]) continue;
-                                        double rule_score = score_list_pl[rsub];
-                                        if (rule_score == 0.0) continue;
-                                        double right_score = inside_rsubs[rsub];
-                                        if (right_score == 0.0) continue;
-
-                                        double common = rule_score * parent_score;
-                                        outside_lsubs[lsub] += common * right_score;
-                                        outside_rsubs[rsub] += common * left_score;
-                                    }
-                                }
+                                kernel.binaryOutside(
+                                    rows, rule.stride, row_mask, parent_score,
+                                    inside.at(begin, mid, ltag), allowed_sub.at(begin, mid, ltag),
+                                    outside.at(begin, mid, ltag),
+                                    inside.at(mid, end, rtag), allowed_sub.at(mid, end, rtag),
+                                    outside_right.at(mid, end, rtag));
                             }
                         }
                     } // psub
                 } // ptag
             } // len > 1
-
-            /*
-            for (int ctag = 0; ctag < num_tags; ++ctag) {
-                int num_csub = tag_set_->numSubtags(ctag, level);
-                for (int csub = 0; csub < num_csub; ++csub) {
-                    cerr << begin << "-" << end << ": " <<
-                        "" << tag_set_->getTagName(ctag) << "[" << csub << "] =" <<
-                        outside.at(begin, end, ctag)[csub] << endl;
-                }
-            }
-            */
-        } // begin
+        }); // begin
     } // len
 }
 
 void LAPCFGParser::pruneCharts(
     CKYTable<bool> & allowed_tag,
-    CKYTable<vector<bool> > & allowed_sub,
-    const CKYTable<vector<double> > & inside,
-    const CKYTable<vector<double> > & outside,
+    CKYTable<uint64_t> & allowed_sub,
+    const CKYChart<double> & inside,
+    const CKYChart<double> & outside,
     int cur_level) const {
     
     const int num_words = allowed_tag.numWords();
@@ -1245,7 +1638,7 @@ void LAPCFGParser::pruneCharts(
                 if (!allowed_tag.at(begin, end, tag)) continue;
 
                 int num_sub = tag_set_->numSubtags(tag, cur_level);
-                bool joined = false;
+                uint64_t & allowed_sub_tag = allowed_sub.at(begin, end, tag);
 
                 for (int sub = 0; sub < num_sub; ++sub) {
                     double posterior =
@@ -1253,12 +1646,10 @@ void LAPCFGParser::pruneCharts(
                         outside.at(begin, end, tag)[sub] /
                         sentence_score;
                     if (posterior < prune_threshold_) {
-                        allowed_sub.at(begin, end, tag)[sub] = false;
+                        allowed_sub_tag &= ~BitUtil::bit(sub);
                         //++num_pruned;
                     }
 
-                    joined = joined || allowed_sub.at(begin, end, tag)[sub];
-
                     //if (score > best_score) {
                     //    best_score = score;
                     //    best_tag = tag;
@@ -1266,7 +1657,7 @@ void LAPCFGParser::pruneCharts(
                     //}
                 }
 
-                allowed_tag.at(begin, end, tag) = joined;
+                allowed_tag.at(begin, end, tag) = (allowed_sub_tag != 0);
             }
 
             //fprintf(stderr, "best[%d:%d] ... %s[%d] = %e\n",
@@ -12,7 +12,9 @@ namespace Ckylark {
 Lexicon::Lexicon(const TagSet & tag_set, int level)
     : tag_set_(tag_set)
     , level_(level)
-    , entry_(tag_set.numTags()) {
+    , entry_(tag_set.numTags())
+    , word_offset_(2, 0)
+    , word_entry_() {
 }
 
 Lexicon::~Lexicon() {
@@ -72,9 +74,84 @@ shared_ptr<Lexicon> Lexicon::loadFromStream(
         }
     }
 
+    lex->makeWordIndex();
     return plex;
 }
 
+shared_ptr<Lexicon> Lexicon::loadFromBinary(
+    BinaryModelReader & reader,
+    const TagSet & tag_set,
+    int level) {
+
+    Lexicon * lex = new Lexicon(tag_set, level);
+    shared_ptr<Lexicon> plex(lex);
+    const int num_tags = tag_set.numTags();
+
+    for (int tag = 0; tag < num_tags; ++tag) {
+        size_t num_entries;
+        size_t num_scores;
+        const int * word_ids = reader.readArray<int>(num_entries);
+        const double * scores = reader.readArray<double>(num_scores);
+        const size_t num_subs = tag_set.numSubtags(tag, level);
+        if (num_scores != num_entries * num_subs) {
+            throw runtime_error("Lexicon::loadFromBinary(): number of subcategories mismatched");
+        }
+
+        for (size_t i = 0; i < num_entries; ++i) {
+            LexiconEntry & ent = lex->getEntryOrCreate(tag, word_ids[i]);
+            for (size_t sub = 0; sub < num_subs; ++sub) {
+                ent.setScore(sub, scores[i * num_subs + sub]);
+            }
+        }
+    }
+
+    lex->makeWordIndex();
+    return plex;
+}
+
+void Lexicon::saveToBinary(BinaryModelWriter & writer) const {
+    // [tag]: word IDs and scores of all entries
+    for (auto & entries : entry_) {
+        vector<int> word_ids;
+        vector<double> scores;
+        for (auto & it : entries) {
+            const LexiconEntry & ent = *it.second;
+            word_ids.push_back(it.first);
+            for (size_t sub = 0; sub < ent.numSubtags(); ++sub) {
+                scores.push_back(ent.getScore(sub));
+            }
+        }
+        writer.writeArray(word_ids);
+        writer.writeArray(scores);
+    }
+}
+
+void Lexicon::makeWordIndex() {
+    int num_words = 0;
+    for (auto & entries : entry_) {
+        if (!entries.empty()) num_words = max(num_words, entries.rbegin()->first + 1);
+    }
+
+    // entries are visited in the order of tags, so lists of words are sorted by tag
+    word_offset_.assign(num_words + 2, 0);
+    for (auto & entries : entry_) {
+        for (auto & it : entries) {
+            ++word_offset_[it.first + 1];
+        }
+    }
+    for (int wid = 0; wid <= num_words; ++wid) {
+        word_offset_[wid + 1] += word_offset_[wid];
+    }
+
+    word_entry_.resize(word_offset_[num_words]);
+    vector<int> next(word_offset_.begin(), word_offset_.begin() + num_words);
+    for (auto & entries : entry_) {
+        for (auto & it : entries) {
+            word_entry_[next[it.first]++] = it.second;
+        }
+    }
+}
+
 const LexiconEntry * Lexicon::getEntry(int tag_id, int word_id) const {
     auto it = entry_[tag_id].find(word_id);
     if (it != entry_[tag_id].end()) {
@@ -4,29 +4,87 @@ using namespace std;
 
 namespace Ckylark {
 
-M1Lexicon::M1Lexicon(const Dictionary & word_table, const TagSet & tag_set)
+M1Lexicon::M1Lexicon(const TagSet & tag_set)
     : tag_set_(tag_set)
-    , score_(tag_set.numTags(), vector<double>(word_table.size(), 0.0))
+    , offset_()
+    , tag_()
+    , score_()
     , scaling_() {
 }
 
-double M1Lexicon::getScalingFactor(int word_id) const {
-    if (scaling_.empty()) {
-        // calculate scaling factors
-        int num_words = score_[0].size();
-        int num_tags = score_.size();
-        scaling_.assign(num_words, 0.0);
-        for (int wid = 0; wid < num_words; ++wid) {
-            for (int tag = 0; tag < num_tags; ++tag) {
-                if (score_[tag][wid] > scaling_[wid]) {
-                    scaling_[wid] = score_[tag][wid];
-                }
-            }
+M1Lexicon::M1Lexicon(const TagSet & tag_set, const vector<vector<Entry> > & entries)
+    : tag_set_(tag_set)
+    , offset_()
+    , tag_()
+    , score_()
+    , scaling_() {
+
+    for (auto & entries_w : entries) {
+        offset_.push_back(tag_.size());
+        for (const Entry & ent : entries_w) {
+            if (ent.score == 0.0) continue;
+            tag_.push_back(ent.tag_id);
+            score_.push_back(ent.score);
         }
     }
+    offset_.push_back(tag_.size());
 
-    return (scaling_[word_id] > 0.0) ? (1.0 / scaling_[word_id]) : 1.0;
+    calculateScalingFactors();
 }
 
-} // namespace Ckylark
+shared_ptr<M1Lexicon> M1Lexicon::loadFromBinary(
+    BinaryModelReader & reader,
+    const Dictionary & word_table,
+    const TagSet & tag_set) {
+
+    shared_ptr<M1Lexicon> lex(new M1Lexicon(tag_set));
+    lex->offset_ = reader.readVector<int>();
+    lex->tag_ = reader.readVector<int>();
+    lex->score_ = reader.readVector<double>();
+
+    if (lex->offset_.size() != word_table.size() + 1) {
+        throw runtime_error("M1Lexicon::loadFromBinary(): number of words mismatched");
+    }
+    if (lex->tag_.size() != lex->score_.size() || static_cast<size_t>(lex->offset_.back()) != lex->tag_.size()) {
+        throw runtime_error("M1Lexicon::loadFromBinary(): number of entries mismatched");
+    }
+    for (size_t wid = 0; wid + 1 < lex->offset_.size(); ++wid) {
+        if (lex->offset_[wid] < 0 || lex->offset_[wid] > lex->offset_[wid + 1]) {
+            throw runtime_error("M1Lexicon::loadFromBinary(): invalid entry offset");
+        }
+    }
+    for (int tag : lex->tag_) {
+        if (tag < 0 || static_cast<size_t>(tag) >= tag_set.numTags()) {
+            throw runtime_error("M1Lexicon::loadFromBinary(): invalid tag");
+        }
+    }
 
+    lex->calculateScalingFactors();
+    return lex;
+}
+
+void M1Lexicon::saveToBinary(BinaryModelWriter & writer) const {
+    // [word] -> [entry]
+    writer.writeArray(offset_);
+    writer.writeArray(tag_);
+    writer.writeArray(score_);
+}
+
+void M1Lexicon::calculateScalingFactors() {
+    const int num_words = offset_.size() - 1;
+    scaling_.assign(num_words, 1.0);
+
+    for (int wid = 0; wid < num_words; ++wid) {
+        double max_score = 0.0;
+        for (int i = offset_[wid]; i < offset_[wid + 1]; ++i) {
+            if (score_[i] > max_score) {
+                max_score = score_[i];
+            }
+        }
+        if (max_score > 0.0) {
+            scaling_[wid] = 1.0 / max_score;
+        }
+    }
+}
+
+} // namespace Ckylark
@@ -77,18 +77,18 @@ M1ModelProjector::M1ModelProjector(
 M1ModelProjector::~M1ModelProjector() {}
 
 shared_ptr<M1Lexicon> M1ModelProjector::generateLexicon() const {
-    M1Lexicon * lex = new M1Lexicon(word_table_, tag_set_);
-    shared_ptr<M1Lexicon> plex(lex);
+    // entries of each word are sorted by tag
+    vector<vector<M1Lexicon::Entry> > entries(word_table_.size());
 
     for (auto & it1 : lexicon_.getEntryList()) {
         for (auto & it2 : it1) {
             // NOTE: cond_prob_[tag_id] == 1.0
             const LexiconEntry & ent = *(it2.second);
-            lex->addScore(ent.tagId(), ent.wordId(), ent.getScore(0));
+            entries[ent.wordId()].push_back(M1Lexicon::Entry { ent.tagId(), ent.getScore(0) });
         }
     }
 
-    return plex;
+    return make_shared<M1Lexicon>(tag_set_, entries);
 }
 
 shared_ptr<M1Grammar> M1ModelProjector::generateGrammar() const {
@@ -117,6 +117,7 @@ shared_ptr<M1Grammar> M1ModelProjector::generateGrammar() const {
         }
     }
 
+    grm->makeIndex();
     return pgrm;
 }
 
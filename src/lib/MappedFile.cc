@@ -0,0 +1,50 @@
+#include <ckylark/MappedFile.h>
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace Ckylark {
+
+MappedFile::MappedFile(const string & path)
+    : path_(path)
+    , data_(nullptr)
+    , size_(0) {
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw runtime_error("MappedFile::MappedFile(): cannot open file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw runtime_error("MappedFile::MappedFile(): cannot get file size: " + path);
+    }
+    size_ = st.st_size;
+
+    if (size_ > 0) {
+        void * addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("MappedFile::MappedFile(): cannot map file: " + path);
+        }
+        data_ = static_cast<const char *>(addr);
+    }
+
+    // the mapping is kept after closing the descriptor
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        munmap(const_cast<char *>(data_), size_);
+    }
+}
+
+} // namespace Ckylark
@@ -1,5 +1,7 @@
 #include <ckylark/Mapping.h>
 
+#include <ckylark/BitUtil.h>
+
 #include <stdexcept>
 
 using namespace std;
@@ -13,7 +15,9 @@ Mapping::Mapping(const TagSet & tag_set, int coarse_level, int fine_level)
     , coarse_map_()
     , fine_map_()
     , f2c_map_()
-    , c2f_map_() {
+    , c2f_offset_()
+    , c2f_index_()
+    , c2f_mask_() {
 
     if (coarse_level_ > fine_level_) {
         throw runtime_error("Mapping::Mapping(): not satisfied: coarse_level <= fine_level");
@@ -31,7 +35,7 @@ Mapping::Mapping(const TagSet & tag_set, int coarse_level, int fine_level)
 
     for (size_t i = 0; i < nc; ++i) {
         size_t fine_nsc = tag_set_.numSubtags(i, fine_level);
-        size_t coarse_nsc = tag_set_.numSubtags(i, fine_level);
+        size_t coarse_nsc = tag_set_.numSubtags(i, coarse_level);
 
         fine_map_.push_back(vector<int>(fine_nsc));
         for (int & x : fine_map_[i]) {
@@ -44,17 +48,32 @@ Mapping::Mapping(const TagSet & tag_set, int coarse_level, int fine_level)
         }
 
         f2c_map_.push_back(vector<int>(fine_nsc, -1));
-        c2f_map_.push_back(vector<vector<int> >(coarse_nsc, vector<int>()));
+        vector<vector<int> > c2f(coarse_nsc);
         auto & tree = tag_set_.getSubtagTree(i);
         for (auto & subtree : tree.getSubtrees(coarse_level, fine_level)) {
             int coarse = subtree->value();
             for (int fine : subtree->getLeaves()) {
                 f2c_map_[i][fine] = coarse;
-                c2f_map_[i][coarse].push_back(fine);
+                c2f[coarse].push_back(fine);
             }
         }
 
+        // flatten coarse-to-fine maps
+        for (auto & fines : c2f) {
+            c2f_offset_.push_back(c2f_index_.size());
+            c2f_index_.insert(c2f_index_.end(), fines.begin(), fines.end());
+            uint64_t mask = 0;
+            for (int fine : fines) {
+                if (fine >= BitUtil::MAX_BITS) {
+                    throw runtime_error("Mapping::Mapping(): too many subtags to be represented by a mask");
+                }
+                mask |= BitUtil::bit(fine);
+            }
+            c2f_mask_.push_back(mask);
+        }
     }
+
+    c2f_offset_.push_back(c2f_index_.size());
 }
 
 Mapping::~Mapping() {}
@@ -1,5 +1,7 @@
 #include <ckylark/ModelProjector.h>
 
+#include <stdexcept>
+
 //#include <cstdio>
 
 using namespace std;
@@ -10,6 +12,7 @@ ModelProjector::ModelProjector(
     const TagSet & tag_set,
     const Lexicon & lexicon,
     const Grammar & grammar,
+    const ExpectedCount & expected_count,
     int fine_level,
     int coarse_level)
     : tag_set_(tag_set)
@@ -21,86 +24,14 @@ ModelProjector::ModelProjector(
 
     if (lexicon_.getLevel() != fine_level_) throw runtime_error("ModelProjector: lexicon level is mismatched");
     if (grammar_.getLevel() != fine_level_) throw runtime_error("ModelProjector: grammar level is mismatched");
+    if (expected_count.getLevel() != fine_level_) throw runtime_error("ModelProjector: expected count level is mismatched");
 
     int num_tags = tag_set.numTags();
     int num_fine_pos = mapping_.getNumFinePos();
     int num_coarse_pos = mapping_.getNumCoarsePos();
-    int root_pos = mapping_.getFinePos(tag_set_.getTagId("ROOT"), 0);
-
-    //  calculate transition probabilities
-
-    vector<vector<double> > transition_prob(num_fine_pos, vector<double>(num_fine_pos, 0.0));
-    
-    for (int ptag = 0; ptag < num_tags; ++ptag) {
-        for (const BinaryRule * rule : grammar_.getBinaryRuleList(ptag)) {
-            auto & score_list = rule->getScoreList();
-            int psc = tag_set_.numSubtags(rule->parent(), fine_level_);
-            int lsc = tag_set_.numSubtags(rule->left(), fine_level_);
-            int rsc = tag_set_.numSubtags(rule->right(), fine_level_);
-            for (int p = 0; p < psc; ++p) {
-                auto & score_list_p = score_list[p];
-                if (score_list_p.empty()) continue;
-                int pm = mapping_.getFinePos(rule->parent(), p);
-                for (int l = 0; l < lsc; ++l) {
-                    auto & score_list_pl = score_list_p[l];
-                    if (score_list_pl.empty()) continue;
-                    int lm = mapping_.getFinePos(rule->left(), l);
-                    for (int r = 0; r < rsc; ++r) {
-                        int rm = mapping_.getFinePos(rule->right(), r);
-                        double score = score_list_pl[r];
-                        transition_prob[pm][lm] += score;
-                        transition_prob[pm][rm] += score;
-                    }
-                }
-            }
-        }
-    }
-
-    for (auto & it1 : grammar_.getUnaryRuleListByPC()) {
-        for (const UnaryRule * rule : it1) {
-            auto & score_list = rule->getScoreList();
-            int psc = tag_set_.numSubtags(rule->parent(), fine_level_);
-            int csc = tag_set_.numSubtags(rule->child(), fine_level_);
-            for (int p = 0; p < psc; ++p) {
-                auto & score_list_p = score_list[p];
-                if (score_list_p.empty()) continue;
-                int pm = mapping_.getFinePos(rule->parent(), p);
-                for (int c = 0; c < csc; ++c) {
-                    int cm = mapping_.getFinePos(rule->child(), c);
-                    transition_prob[pm][cm] += score_list_p[c];
-                }
-            }
-        }
-    }
-
-    // calcluate expected counts
-
-    vector<double> exp_count(num_fine_pos, 0.0);
-    vector<double> temp_count(num_fine_pos, 0.0);
-    exp_count[root_pos] = 1.0;
-    temp_count[root_pos] = 1.0;
-    const int NUM_ITERATION = 50;
-
-    for (int iteration = 0; iteration < NUM_ITERATION; ++iteration) {
-        for (int i = 0; i < num_fine_pos; ++i) {
-            for (int j = 0; j < num_fine_pos; ++j) {
-                temp_count[i] += transition_prob[j][i] * exp_count[j];
-            }
-        }
-
-        //double sum = 0.0;
-        for (int i = 0; i < num_fine_pos; ++i) {
-            //sum += temp_count[i];
-            exp_count[i] = temp_count[i];
-            temp_count[i] = 0.0;
-        }
-        exp_count[root_pos] = 1.0;
-        temp_count[root_pos] = 1.0;
-
-        //printf("iteration %d: sum=%f\n", iteration+1, sum);
-    }
 
     // calculate conditional probabilities
+    // (expected counts are solved once per level and shared with scaling factors)
 
     cond_prob_.assign(num_fine_pos, 0.0);
     vector<double> total(num_coarse_pos, 0.0);
@@ -109,9 +40,8 @@ ModelProjector::ModelProjector(
         int fine_num_subtags = tag_set_.numSubtags(tag, fine_level_);
         for (int fine_subtag = 0; fine_subtag < fine_num_subtags; ++fine_subtag) {
             int coarse_subtag = mapping_.getFineToCoarseMap(tag, fine_subtag);
-            int fine_pos = mapping_.getFinePos(tag, fine_subtag);
             int coarse_pos = mapping_.getCoarsePos(tag, coarse_subtag);
-            total[coarse_pos] += exp_count[fine_pos];
+            total[coarse_pos] += expected_count.getCount(tag, fine_subtag);
         }
     }
 
@@ -121,7 +51,7 @@ ModelProjector::ModelProjector(
             int coarse_subtag = mapping_.getFineToCoarseMap(tag, fine_subtag);
             int fine_pos = mapping_.getFinePos(tag, fine_subtag);
             int coarse_pos = mapping_.getCoarsePos(tag, coarse_subtag);
-            cond_prob_[fine_pos] = exp_count[fine_pos] / total[coarse_pos];
+            cond_prob_[fine_pos] = expected_count.getCount(tag, fine_subtag) / total[coarse_pos];
         }
     }
 
@@ -150,6 +80,7 @@ shared_ptr<Lexicon> ModelProjector::generateLexicon() const {
         }
     }
     
+    lex->makeWordIndex();
     return plex;
 }
 
@@ -0,0 +1,56 @@
+#include <ckylark/OOVLexicon.h>
+
+#include <ckylark/StringUtil.h>
+
+using namespace std;
+
+namespace Ckylark {
+
+OOVLexicon::OOVLexicon(const Lexicon & lexicon, const Dictionary & word_table)
+    : lexicon_(lexicon) {
+
+    const TagSet & tag_set = lexicon.getTagSet();
+    int level = lexicon.getLevel();
+    int num_tags = tag_set.numTags();
+
+    // generate OOV lexicon entries
+    for (int tag = 0; tag < num_tags; ++tag) {
+        entry_.push_back(new LexiconEntry(tag, -1, tag_set.numSubtags(tag, level)));
+    }
+
+    // sum all UNK* lexicon probabilities
+    for (const string & word : word_table.getWordList()) {
+        if (StringUtil::startsWith(word, "UNK")) {
+            int wid = word_table.getId(word);
+
+            for (int tag = 0; tag < num_tags; ++tag) {
+                const LexiconEntry * ent_from = lexicon.getEntry(tag, wid);
+                if (!ent_from) continue;
+                LexiconEntry & ent_to = *entry_[tag];
+                int num_subs = tag_set.numSubtags(tag, level);
+
+                for (int sub = 0; sub < num_subs; ++sub)
+                    ent_to.addScore(sub, ent_from->getScore(sub));
+            }
+        }
+    }
+
+    for (int tag = 0; tag < num_tags; ++tag) {
+        const LexiconEntry & ent = *entry_[tag];
+        for (size_t sub = 0; sub < ent.numSubtags(); ++sub) {
+            if (ent.getScore(sub) != 0.0) {
+                tag_list_.push_back(tag);
+                break;
+            }
+        }
+    }
+}
+
+OOVLexicon::~OOVLexicon() {
+    for (auto * entry : entry_) {
+        delete entry;
+    }
+}
+
+} // namespace Ckylark
+
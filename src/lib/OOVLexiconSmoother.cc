@@ -14,46 +14,33 @@ OOVLexiconSmoother::OOVLexiconSmoother(
     double ratio)
     : LexiconSmoother(lexicon)
     , ratio_(ratio)
+    , own_oov_lexicon_(new OOVLexicon(lexicon, word_table))
+    , oov_lexicon_(*own_oov_lexicon_)
     , cur_ent_(nullptr)
     , cur_tag_(-1) {
     
     if (ratio < 0.0 || ratio > 1.0) {
         throw runtime_error("OOVLexiconSmoother::OOVLexiconSmoother: invalid value: ratio");
     }
-
-    const TagSet & tag_set = lexicon.getTagSet();
-    int level = lexicon.getLevel();
-    int num_tags = tag_set.numTags();
-
-    // generate OOV lexicon entries
-    for (int tag = 0; tag < num_tags; ++tag) {
-        oov_entries_.push_back(new LexiconEntry(tag, -1, tag_set.numSubtags(tag, level)));
-    }
-
-    // sum all UNK* lexicon probabilities
-    for (const string & word : word_table.getWordList()) {
-        if (StringUtil::startsWith(word, "UNK")) {
-            int wid = word_table.getId(word);
-
-            for (int tag = 0; tag < num_tags; ++tag) {
-                const LexiconEntry * ent_from = lexicon.getEntry(tag, wid);
-                if (!ent_from) continue;
-                LexiconEntry & ent_to = *oov_entries_[tag];
-                int num_subs = tag_set.numSubtags(tag, level);
-
-                for (int sub = 0; sub < num_subs; ++sub)
-                    ent_to.addScore(sub, ent_from->getScore(sub));
-            }
-        }
-    }
 }
 
-OOVLexiconSmoother::~OOVLexiconSmoother() {
-    for (auto * entry : oov_entries_) {
-        delete entry;
+OOVLexiconSmoother::OOVLexiconSmoother(
+    const OOVLexicon & oov_lexicon,
+    double ratio)
+    : LexiconSmoother(oov_lexicon.getLexicon())
+    , ratio_(ratio)
+    , own_oov_lexicon_()
+    , oov_lexicon_(oov_lexicon)
+    , cur_ent_(nullptr)
+    , cur_tag_(-1) {
+    
+    if (ratio < 0.0 || ratio > 1.0) {
+        throw runtime_error("OOVLexiconSmoother::OOVLexiconSmoother: invalid value: ratio");
     }
 }
 
+OOVLexiconSmoother::~OOVLexiconSmoother() {}
+
 bool OOVLexiconSmoother::prepare(int tag_id, int word_id) {
     auto & lexicon = getLexicon();
     cur_ent_ = lexicon.getEntry(tag_id, word_id);
@@ -64,7 +51,7 @@ bool OOVLexiconSmoother::prepare(int tag_id, int word_id) {
 double OOVLexiconSmoother::getScore(int subtag_id) const {
     return
         (1.0 - ratio_) * (cur_ent_ ? cur_ent_->getScore(subtag_id) : 0.0) +
-        ratio_ * oov_entries_[cur_tag_]->getScore(subtag_id);
+        ratio_ * oov_lexicon_.getEntry(cur_tag_).getScore(subtag_id);
 }
 
 M1OOVLexiconSmoother::M1OOVLexiconSmoother(
@@ -98,7 +85,7 @@ M1OOVLexiconSmoother::M1OOVLexiconSmoother(
 
 M1OOVLexiconSmoother::~M1OOVLexiconSmoother() {}
 
-double M1OOVLexiconSmoother::getScore(int tag_id, int word_id) {
+double M1OOVLexiconSmoother::getScore(int tag_id, int word_id) const {
     return
         (1.0 - ratio_) * (getLexicon().getScore(tag_id, word_id)) +
         ratio_ * oov_scores_[tag_id];
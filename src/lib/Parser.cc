@@ -0,0 +1,53 @@
+#include <ckylark/Parser.h>
+
+#include <ckylark/Timer.h>
+
+using namespace std;
+
+namespace Ckylark {
+
+vector<ParserResult> Parser::parseBatch(
+    const vector<vector<string> > & sentences,
+    const ParserSetting & setting,
+    const ParserBatchOptions & options) const {
+
+    BatchScheduler local_scheduler(options.num_threads);
+    BatchScheduler & scheduler = options.scheduler ? *options.scheduler : local_scheduler;
+
+    return runBatch(sentences, options, scheduler, [&](size_t i, int) {
+        return parse(sentences[i], setting);
+    });
+}
+
+vector<ParserResult> Parser::runBatch(
+    const vector<vector<string> > & sentences,
+    const ParserBatchOptions & options,
+    BatchScheduler & scheduler,
+    const function<ParserResult(size_t, int)> & parse_one) {
+
+    const size_t num_sentences = sentences.size();
+    vector<ParserResult> results(num_sentences);
+    vector<double> parse_times(num_sentences, 0.0);
+
+    vector<double> costs;
+    costs.reserve(num_sentences);
+    for (const vector<string> & sentence : sentences) {
+        costs.push_back(BatchScheduler::estimateParseCost(sentence.size()));
+    }
+
+    // each call writes only its own elements, so the input order is kept
+    scheduler.run(costs, [&](size_t i, int thread) {
+        Timer timer;
+        timer.start();
+        results[i] = parse_one(i, thread);
+        parse_times[i] = timer.stop();
+    });
+
+    if (options.parse_times) {
+        options.parse_times->swap(parse_times);
+    }
+
+    return results;
+}
+
+} // namespace Ckylark
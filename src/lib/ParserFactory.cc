@@ -1,6 +1,8 @@
 #include <ckylark/ParserFactory.h>
 
+#include <ckylark/BinaryModel.h>
 #include <ckylark/LAPCFGParser.h>
+#include <ckylark/ScoreKernelFactory.h>
 #include <ckylark/Tracer.h>
 
 #include <boost/format.hpp>
@@ -18,19 +20,26 @@ std::shared_ptr<Parser> ParserFactory::create(const map<string, any> & args) {
 
     if (method == "lapcfg") {
         Tracer::println(1, "Parsing method: LAPCFG");
-        std::shared_ptr<LAPCFGParser> parser = LAPCFGParser::loadFromBerkeleyDump(
-            any_cast<string>(args.at("model")),
-            any_cast<double>(args.at("smooth-unklex")),
-            any_cast<string>(args.at("scaling")));
+        string model = any_cast<string>(args.at("model"));
+        double smooth_unklex = any_cast<double>(args.at("smooth-unklex"));
+        string scaling = any_cast<string>(args.at("scaling"));
+        // binary models are memory-mapped instead of parsing text dumps
+        std::shared_ptr<LAPCFGParser> parser = BinaryModel::isBinaryModel(model)
+            ? LAPCFGParser::loadFromBinary(model, smooth_unklex, scaling)
+            : LAPCFGParser::loadFromBerkeleyDump(model, smooth_unklex, scaling);
         int fine_level = any_cast<int>(args.at("fine-level"));
         parser->setFineLevel(fine_level);
         parser->setPruningThreshold(any_cast<double>(args.at("prune-threshold")));
         parser->setDoM1Preparse(any_cast<bool>(args.at("do-m1-preparse")));
         parser->setForceGenerate(any_cast<bool>(args.at("force-generate")));
+        parser->setScoreKernel(ScoreKernelFactory::create(any_cast<string>(args.at("kernel"))));
+        parser->setNumSpanThreads(any_cast<int>(args.at("span-threads")));
         Tracer::println(1, (format("fine-level: %d (requested: %d)") % parser->getFineLevel() % fine_level).str());
         Tracer::println(1, (format("prune-threshold: %.3e") % parser->getPruningThreshold()).str());
         Tracer::println(1, (format("smooth-unklex: %.3e") % parser->getUNKLexiconSmoothing()).str());
         Tracer::println(1, string("do-m1-preparse: ") + (parser->getDoM1Preparse() ? "yes" : "no"));
+        Tracer::println(1, "kernel: " + parser->getScoreKernel().getName());
+        Tracer::println(1, (format("span-threads: %d") % parser->getNumSpanThreads()).str());
         return std::shared_ptr<Parser>(parser);
     } else {
         // factory does not know such parser
@@ -0,0 +1,65 @@
+#include <ckylark/ScalarScoreKernel.h>
+
+#include <ckylark/BitUtil.h>
+
+using namespace std;
+
+namespace Ckylark {
+
+double ScalarScoreKernel::binaryInside(
+    const double * rows, int stride, uint64_t row_mask,
+    const double * left, uint64_t lmask,
+    const double * right, uint64_t rmask) const {
+
+    double sum = 0.0;
+
+    for (uint64_t lsub_mask = lmask & row_mask; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+        int lsub = BitUtil::lowest(lsub_mask);
+        double left_score = left[lsub];
+        if (left_score == 0.0) continue;
+        const double * row = rows + BitUtil::count(row_mask & (BitUtil::bit(lsub) - 1)) * stride;
+        double row_sum = 0.0;
+
+        for (uint64_t rsub_mask = rmask; rsub_mask; rsub_mask = BitUtil::dropLowest(rsub_mask)) {
+            int rsub = BitUtil::lowest(rsub_mask);
+            row_sum += row[rsub] * right[rsub];
+        }
+
+        sum += left_score * row_sum;
+    }
+
+    return sum;
+}
+
+void ScalarScoreKernel::binaryOutside(
+    const double * rows, int stride, uint64_t row_mask, double parent,
+    const double * left, uint64_t lmask, double * outside_left,
+    const double * right, uint64_t rmask, double * outside_right) const {
+
+    for (uint64_t lsub_mask = lmask & row_mask; lsub_mask; lsub_mask = BitUtil::dropLowest(lsub_mask)) {
+        int lsub = BitUtil::lowest(lsub_mask);
+        double left_score = left[lsub];
+        if (left_score == 0.0) continue;
+        const double * row = rows + BitUtil::count(row_mask & (BitUtil::bit(lsub) - 1)) * stride;
+        double parent_left = parent * left_score;
+        double row_sum = 0.0;
+
+        for (uint64_t rsub_mask = rmask; rsub_mask; rsub_mask = BitUtil::dropLowest(rsub_mask)) {
+            int rsub = BitUtil::lowest(rsub_mask);
+            double right_score = right[rsub];
+            if (right_score == 0.0) continue;
+            row_sum += row[rsub] * right_score;
+            outside_right[rsub] += parent_left * row[rsub];
+        }
+
+        outside_left[lsub] += parent * row_sum;
+    }
+}
+
+void ScalarScoreKernel::accumulate(double * dest, double scale, const double * src, int size) const {
+    for (int i = 0; i < size; ++i) {
+        dest[i] += scale * src[i];
+    }
+}
+
+} // namespace Ckylark
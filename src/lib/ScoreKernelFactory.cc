@@ -0,0 +1,51 @@
+#include <ckylark/ScoreKernelFactory.h>
+
+#include <ckylark/ScalarScoreKernel.h>
+#include <ckylark/AVX2ScoreKernel.h>
+#include <ckylark/AVX512ScoreKernel.h>
+#include <ckylark/CheckedScoreKernel.h>
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace Ckylark {
+
+bool ScoreKernelFactory::isSupported(const string & name) {
+    if (name == "scalar") return true;
+#if defined(__x86_64__) || defined(__i386__)
+    // __builtin_cpu_supports() also checks that the OS saves the extended registers
+    __builtin_cpu_init();
+    if (name == "avx2") return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("popcnt");
+    if (name == "avx512") return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+#endif
+    return false;
+}
+
+shared_ptr<ScoreKernel> ScoreKernelFactory::create(const string & name) {
+
+    if (name == "auto") {
+        if (isSupported("avx512")) return create("avx512");
+        if (isSupported("avx2")) return create("avx2");
+        return create("scalar");
+    } else if (name == "check") {
+        return shared_ptr<ScoreKernel>(new CheckedScoreKernel(create("scalar"), create("auto")));
+    } else if (name == "scalar") {
+        return shared_ptr<ScoreKernel>(new ScalarScoreKernel());
+    } else if (name != "avx2" && name != "avx512") {
+        throw runtime_error("ScoreKernelFactory::create(): unknown kernel: " + name);
+    }
+
+    if (!isSupported(name)) {
+        throw runtime_error("ScoreKernelFactory::create(): kernel is not supported by this CPU: " + name);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (name == "avx2") return shared_ptr<ScoreKernel>(new AVX2ScoreKernel());
+    else return shared_ptr<ScoreKernel>(new AVX512ScoreKernel());
+#else
+    return shared_ptr<ScoreKernel>();
+#endif
+}
+
+} // namespace Ckylark
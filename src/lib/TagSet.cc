@@ -15,7 +15,8 @@ namespace Ckylark {
 TagSet::TagSet()
     : depth_(0)
     , tree_list_()
-    , num_subtags_() {
+    , num_subtags_()
+    , subtag_offsets_() {
 }
 
 TagSet::~TagSet() {
@@ -50,20 +51,84 @@ shared_ptr<TagSet> TagSet::loadFromStream(InputStream & stream) {
         tags->tree_list_.push_back(makeSubtagTree(tok, pos));
     }
 
-    tags->checkDepth();
+    tags->finishLoading();
+    return ptags;
+}
+
+shared_ptr<TagSet> TagSet::loadFromBinary(BinaryModelReader & reader) {
+    TagSet * tags = new TagSet();
+    shared_ptr<TagSet> ptags(tags);
+
+    // subtag trees are stored as the preorder list of (value, #children)
+    function<Tree<int> *(const int *, size_t, size_t &)> makeTree
+        = [&](const int * nodes, size_t size, size_t & pos) -> Tree<int> * {
+
+        if (pos + 2 > size) throw runtime_error("TagSet::loadFromBinary(): invalid subtag tree");
+        Tree<int> * node = new Tree<int>(nodes[pos]);
+        int num_children = nodes[pos + 1];
+        pos += 2;
+        try {
+            for (int i = 0; i < num_children; ++i) {
+                node->addChild(makeTree(nodes, size, pos));
+            }
+        } catch (...) {
+            delete node;
+            throw;
+        }
+        return node;
+    };
+
+    // ROOT is not stored
+    uint32_t num_tags = reader.read<uint32_t>();
+    for (uint32_t tag = 0; tag < num_tags; ++tag) {
+        tags->tag_table_.addWord(reader.readString());
+        size_t size;
+        const int * nodes = reader.readArray<int>(size);
+        size_t pos = 0;
+        tags->tree_list_.push_back(makeTree(nodes, size, pos));
+    }
+
+    tags->finishLoading();
+    return ptags;
+}
+
+void TagSet::saveToBinary(BinaryModelWriter & writer) const {
+    function<void(const Tree<int> &, vector<int> &)> flatten
+        = [&](const Tree<int> & node, vector<int> & nodes) {
+
+        nodes.push_back(node.value());
+        nodes.push_back(node.numChildren());
+        for (size_t i = 0; i < node.numChildren(); ++i) {
+            flatten(node.child(i), nodes);
+        }
+    };
+
+    const int root_tag = getTagId("ROOT");
+    writer.write<uint32_t>(numTags() - 1);
+    for (size_t tag = 0; tag < numTags(); ++tag) {
+        if (static_cast<int>(tag) == root_tag) continue;
+        vector<int> nodes;
+        flatten(*tree_list_[tag], nodes);
+        writer.writeString(getTagName(tag));
+        writer.writeArray(nodes);
+    }
+}
+
+void TagSet::finishLoading() {
+    checkDepth();
 
     // add ROOT tag
-    tags->tag_table_.addWord("ROOT");
+    tag_table_.addWord("ROOT");
     Tree<int> * node = new Tree<int>(0);
-    for (size_t i = 1; i < tags->depth_; ++i) {
+    for (size_t i = 1; i < depth_; ++i) {
         Tree<int> * parent = new Tree<int>(0);
         parent->addChild(node);
         node = parent;
     }
-    tags->tree_list_.push_back(node);
+    tree_list_.push_back(node);
 
     // calculate #subtags
-    tags->num_subtags_.assign(tags->numTags(), vector<size_t>(tags->getDepth(), -1));
+    num_subtags_.assign(numTags(), vector<size_t>(getDepth(), -1));
 
     function<size_t(Tree<int> &, int)> numSubtagsByNode
         = [&](Tree<int> & node, int rest_depth) -> size_t {
@@ -74,13 +139,21 @@ shared_ptr<TagSet> TagSet::loadFromStream(InputStream & stream) {
         return n;
     };
 
-    for (size_t tag = 0; tag < tags->numTags(); ++tag) {
-        for (size_t level = 0; level <  tags->getDepth(); ++level) {
-            tags->num_subtags_[tag][level] = numSubtagsByNode(*(tags->tree_list_[tag]), level);
+    for (size_t tag = 0; tag < numTags(); ++tag) {
+        for (size_t level = 0; level <  getDepth(); ++level) {
+            num_subtags_[tag][level] = numSubtagsByNode(*(tree_list_[tag]), level);
         }
     }
 
-    return ptags;
+    // calculate offsets of subtags
+    subtag_offsets_.assign(getDepth(), vector<int>(numTags() + 1, 0));
+
+    for (size_t level = 0; level < getDepth(); ++level) {
+        auto & offsets = subtag_offsets_[level];
+        for (size_t tag = 0; tag < numTags(); ++tag) {
+            offsets[tag + 1] = offsets[tag] + num_subtags_[tag][level];
+        }
+    }
 }
 
 Tree<int> * TagSet::makeSubtagTree(const vector<string> & tok, int & pos) {
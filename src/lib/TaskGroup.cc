@@ -0,0 +1,78 @@
+#include <ckylark/TaskGroup.h>
+
+#include <ckylark/Timer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+using namespace std;
+
+namespace Ckylark {
+
+TaskGroup::TaskGroup(int num_threads)
+    : num_threads_(num_threads)
+    , tasks_()
+    , wall_time_(0.0)
+    , finished_(false) {
+
+    if (num_threads_ <= 0) {
+        num_threads_ = thread::hardware_concurrency();
+        if (num_threads_ <= 0) num_threads_ = 1;
+    }
+}
+
+TaskGroup::~TaskGroup() {}
+
+void TaskGroup::add(const string & name, const function<void()> & func) {
+    if (finished_) {
+        tasks_.clear();
+        finished_ = false;
+    }
+    tasks_.push_back(Task { name, func, 0.0 });
+}
+
+void TaskGroup::run() {
+    Timer wall_timer;
+    wall_timer.start();
+
+    vector<exception_ptr> errors(tasks_.size());
+    atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        Timer timer;
+        for (size_t i = next++; i < tasks_.size(); i = next++) {
+            timer.start();
+            try {
+                tasks_[i].func();
+            } catch (...) {
+                errors[i] = current_exception();
+            }
+            tasks_[i].elapsed = timer.stop();
+        }
+    };
+
+    int num_workers = min<int>(num_threads_, tasks_.size());
+
+    if (num_workers <= 1) {
+        worker();
+    } else {
+        vector<thread> workers;
+        for (int i = 0; i < num_workers; ++i) {
+            workers.push_back(thread(worker));
+        }
+        for (thread & t : workers) {
+            t.join();
+        }
+    }
+
+    wall_time_ = wall_timer.stop();
+    finished_ = true;
+
+    for (exception_ptr & error : errors) {
+        if (error) rethrow_exception(error);
+    }
+}
+
+} // namespace Ckylark
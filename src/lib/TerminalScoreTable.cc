@@ -0,0 +1,64 @@
+#include <ckylark/TerminalScoreTable.h>
+
+#include <ckylark/OOVLexiconSmoother.h>
+
+using namespace std;
+
+namespace Ckylark {
+
+TerminalScoreTable::TerminalScoreTable(
+    const OOVLexicon & oov_lexicon,
+    const ScalingFactor & scaling_factor,
+    int num_words,
+    double ratio)
+    : word_offset_()
+    , word_scaling_()
+    , entry_tag_()
+    , entry_pos_()
+    , score_()
+    , oov_tag_()
+    , oov_pos_()
+    , oov_score_() {
+
+    const Lexicon & lexicon = oov_lexicon.getLexicon();
+    OOVLexiconSmoother smoother(oov_lexicon, ratio);
+
+    // entries of each word (the last slot is for unknown words)
+    for (int slot = 0; slot <= num_words; ++slot) {
+        int wid = (slot < num_words) ? slot : -1;
+        double word_scaling = scaling_factor.getLexiconScalingFactor(wid);
+        word_offset_.push_back(entry_tag_.size());
+        word_scaling_.push_back(word_scaling);
+
+        auto ent_end = lexicon.getWordEntryEnd(wid);
+        for (auto ent = lexicon.getWordEntryBegin(wid); ent != ent_end; ++ent) {
+            int tag = (*ent)->tagId();
+            int num_subs = (*ent)->numSubtags();
+            smoother.prepare(tag, wid);
+            entry_tag_.push_back(tag);
+            entry_pos_.push_back(score_.size());
+            for (int sub = 0; sub < num_subs; ++sub) {
+                score_.push_back(word_scaling * smoother.getScore(sub));
+            }
+        }
+    }
+    word_offset_.push_back(entry_tag_.size());
+
+    // OOV-only scores
+    if (ratio == 0.0) return;
+
+    for (int tag : oov_lexicon.getTagList()) {
+        int num_subs = oov_lexicon.getEntry(tag).numSubtags();
+        smoother.prepare(tag, -1);
+        oov_tag_.push_back(tag);
+        oov_pos_.push_back(oov_score_.size());
+        for (int sub = 0; sub < num_subs; ++sub) {
+            oov_score_.push_back(smoother.getScore(sub));
+        }
+    }
+}
+
+TerminalScoreTable::~TerminalScoreTable() {}
+
+} // namespace Ckylark
+
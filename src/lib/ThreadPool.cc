@@ -0,0 +1,114 @@
+#include <ckylark/ThreadPool.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Ckylark {
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_threads_(num_threads)
+    , workers_()
+    , mutex_()
+    , work_cond_()
+    , done_cond_()
+    , loops_()
+    , stopping_(false) {
+
+    if (num_threads < 1) {
+        throw runtime_error("ThreadPool::ThreadPool(): invalid value: num_threads");
+    }
+
+    // the caller of parallelFor() works as one of threads
+    for (int i = 1; i < num_threads; ++i) {
+        workers_.push_back(thread(&ThreadPool::runWorker, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cond_.notify_all();
+    for (thread & t : workers_) {
+        t.join();
+    }
+}
+
+void ThreadPool::runLoop(int size, LoopFunc func, const void * context) {
+    if (size <= 0) return;
+
+    Loop loop;
+    loop.func = func;
+    loop.context = context;
+    loop.size = size;
+    loop.next_index = 0;
+    loop.next_slot = 1;
+    loop.num_active = 1; // the caller
+    loop.error_index = size;
+
+    if (size > 1 && !workers_.empty()) {
+        {
+            lock_guard<mutex> lock(mutex_);
+            loops_.push_back(&loop);
+        }
+        work_cond_.notify_all();
+    }
+
+    processLoop(loop, 0);
+
+    {
+        unique_lock<mutex> lock(mutex_);
+        auto it = find(loops_.begin(), loops_.end(), &loop);
+        if (it != loops_.end()) loops_.erase(it);
+        --loop.num_active;
+        done_cond_.wait(lock, [&]() { return loop.num_active == 0; });
+    }
+
+    if (loop.error) rethrow_exception(loop.error);
+}
+
+void ThreadPool::runWorker() {
+    unique_lock<mutex> lock(mutex_);
+
+    while (true) {
+        work_cond_.wait(lock, [&]() { return stopping_ || !loops_.empty(); });
+        if (stopping_) return;
+
+        Loop & loop = *loops_.front();
+        int slot = loop.next_slot++;
+        ++loop.num_active;
+        if (loop.next_slot >= num_threads_) {
+            // no more threads can join
+            loops_.pop_front();
+        }
+
+        lock.unlock();
+        processLoop(loop, slot);
+        lock.lock();
+
+        // all indices are claimed, so other threads do not join any more
+        auto it = find(loops_.begin(), loops_.end(), &loop);
+        if (it != loops_.end()) loops_.erase(it);
+        if (--loop.num_active == 0) done_cond_.notify_all();
+    }
+}
+
+void ThreadPool::processLoop(Loop & loop, int slot) {
+    for (int i = loop.next_index++; i < loop.size; i = loop.next_index++) {
+        try {
+            loop.func(loop.context, i, slot);
+        } catch (...) {
+            lock_guard<mutex> lock(mutex_);
+            if (i < loop.error_index) {
+                loop.error = current_exception();
+                loop.error_index = i;
+            }
+        }
+    }
+}
+
+} // namespace Ckylark
+
@@ -7,16 +7,16 @@ using namespace std;
 namespace Ckylark {
 
 Timer::Timer()
-    : elapsed_(0)
-    , start_time_(0)
+    : elapsed_(chrono::steady_clock::duration::zero())
+    , start_time_()
     , running_(false) {
 }
 
 Timer::~Timer() {}
 
 void Timer::reset() {
-    elapsed_ = 0;
-    start_time_ = 0;
+    elapsed_ = chrono::steady_clock::duration::zero();
+    start_time_ = chrono::steady_clock::time_point();
     running_ = false;
 }
 
@@ -26,11 +26,11 @@ void Timer::start() {
     }
 
     running_ = true;
-    start_time_ = clock();
+    start_time_ = chrono::steady_clock::now();
 }
 
 double Timer::stop() {
-    clock_t lap = clock() - start_time_;
+    chrono::steady_clock::duration lap = chrono::steady_clock::now() - start_time_;
     
     if (!running_) {
         throw runtime_error("Timer: already stopping");
@@ -39,11 +39,11 @@ double Timer::stop() {
     running_ = false;
     elapsed_ += lap;
 
-    return lap / (double)CLOCKS_PER_SEC;
+    return chrono::duration<double>(lap).count();
 }
 
 double Timer::elapsed() const {
-    return elapsed_ / (double)CLOCKS_PER_SEC;
+    return chrono::duration<double>(elapsed_).count();
 }
 
 } // namespace Ckylark
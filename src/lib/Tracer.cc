@@ -1,26 +1,33 @@
 #include <ckylark/Tracer.h>
 
 #include <iostream>
+#include <mutex>
 
 using namespace std;
 
 namespace Ckylark {
 
-unsigned int Tracer::trace_level_ = 0;
+namespace {
+
+mutex output_mutex;
+
+} // namespace
+
+atomic<unsigned int> Tracer::trace_level_(0);
 
 void Tracer::print(unsigned int level, const string & text) {
     if (level > trace_level_) return;
-    cerr << text;
+    write(text);
 }
 
 void Tracer::println(unsigned int level, const string & text) {
     if (level > trace_level_) return;
-    cerr << text << endl;
+    write(text + '\n');
 }
 
 void Tracer::println(unsigned int level) {
     if (level > trace_level_) return;
-    cerr << endl;
+    write("\n");
 }
 
 unsigned int Tracer::getTraceLevel() {
@@ -31,5 +38,9 @@ void Tracer::setTraceLevel(unsigned int value) {
     trace_level_ = value;
 }
 
-} // namespace Ckylark
+void Tracer::write(const string & text) {
+    lock_guard<mutex> lock(output_mutex);
+    cerr << text << flush;
+}
 
+} // namespace Ckylark
@@ -0,0 +1,294 @@
+// parses the same sentences from many threads on one shared LAPCFGParser,
+// and checks that all results are identical to a single-threaded run.
+
+#include <ckylark/LAPCFGParser.h>
+#include <ckylark/ParserBatchOptions.h>
+#include <ckylark/SExprFormatter.h>
+#include <ckylark/ScoreKernelFactory.h>
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace Ckylark;
+
+namespace {
+
+const int NUM_THREADS = 8;
+const int NUM_ROUNDS = 3;
+const int NUM_SENTENCES = 40;
+const int NUM_SUBTAGS = 4; // at the finest level
+
+// deterministic pseudo random numbers
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+    uint32_t next() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state_ >> 33;
+    }
+    int nextInt(int n) { return next() % n; }
+    double nextDouble() { return (next() + 0.5) / 2147483648.0; }
+private:
+    uint64_t state_;
+}; // class Random
+
+const vector<string> PHRASE_TAGS { "S", "NP", "VP", "PP", "@S", "@NP", "@VP" };
+
+const vector<pair<string, vector<string> > > POS_WORDS {
+    { "DT", { "the", "a", "this", "that" } },
+    { "NN", { "dog", "cat", "park", "telescope", "John", "UNK", "UNK-LC", "UNK-CAPS", "UNK-INITC" } },
+    { "NNS", { "dogs", "cats", "ideas", "UNK-LC-s" } },
+    { "VBZ", { "sees", "runs", "eats", "UNK-LC-s" } },
+    { "VBD", { "saw", "ran", "walked", "UNK-LC-ed" } },
+    { "IN", { "in", "on", "with", "that" } },
+    { "JJ", { "big", "small", "red", "UNK-LC" } },
+    { "PRP", { "he", "she", "they" } },
+    { "RB", { "quickly", "slowly", "UNK-LC-ly" } },
+    { "CD", { "one", "two", "1990", "UNK-NUM" } },
+    { ".", { ".", "!" } },
+};
+
+// write a small Berkeley dump with 3 levels (1, 2 and 4 subtags)
+void writeModel(const string & prefix) {
+    Random rnd(7);
+    vector<string> tags = PHRASE_TAGS;
+    vector<string> words;
+    for (const auto & pos : POS_WORDS) {
+        tags.push_back(pos.first);
+        for (const string & w : pos.second) {
+            if (find(words.begin(), words.end(), w) == words.end()) words.push_back(w);
+        }
+    }
+
+    ofstream words_ofs(prefix + ".words");
+    for (const string & w : words) {
+        words_ofs << w << '\n';
+    }
+
+    ofstream splits_ofs(prefix + ".splits");
+    for (const string & t : tags) {
+        splits_ofs << t << "\t(0 (0 0 1) (1 2 3))\n";
+    }
+
+    ofstream lexicon_ofs(prefix + ".lexicon");
+    for (const auto & pos : POS_WORDS) {
+        for (const string & w : pos.second) {
+            lexicon_ofs << pos.first << ' ' << w << " [";
+            for (int i = 0; i < NUM_SUBTAGS; ++i) {
+                lexicon_ofs << (i ? ", " : "") << 0.2 * rnd.nextDouble();
+            }
+            lexicon_ofs << "]\n";
+        }
+    }
+
+    ofstream grammar_ofs(prefix + ".grammar");
+    for (const string & parent : PHRASE_TAGS) {
+        vector<pair<string, string> > pairs;
+        for (int i = 0; i < 12; ++i) {
+            pairs.push_back(make_pair(tags[rnd.nextInt(tags.size())], tags[rnd.nextInt(tags.size())]));
+        }
+        vector<string> unaries;
+        while (unaries.size() < 2) {
+            const string & child = tags[rnd.nextInt(tags.size())];
+            if (child != parent) unaries.push_back(child);
+        }
+        for (int p = 0; p < NUM_SUBTAGS; ++p) {
+            vector<string> rules;
+            vector<double> scores;
+            for (const auto & lr : pairs) {
+                for (int l = 0; l < NUM_SUBTAGS; ++l) {
+                    for (int r = 0; r < NUM_SUBTAGS; ++r) {
+                        rules.push_back((boost::format("%s_%d -> %s_%d %s_%d") % parent % p % lr.first % l % lr.second % r).str());
+                        scores.push_back(rnd.nextDouble());
+                    }
+                }
+            }
+            for (const string & child : unaries) {
+                for (int c = 0; c < NUM_SUBTAGS; ++c) {
+                    rules.push_back((boost::format("%s_%d -> %s_%d") % parent % p % child % c).str());
+                    scores.push_back(0.5 * rnd.nextDouble());
+                }
+            }
+            double total = 0.0;
+            for (double s : scores) total += s;
+            for (size_t i = 0; i < rules.size(); ++i) {
+                grammar_ofs << rules[i] << ' ' << scores[i] / total << '\n';
+            }
+        }
+    }
+    for (const char * child : { "S", "NP", "VP" }) {
+        for (int c = 0; c < NUM_SUBTAGS; ++c) {
+            grammar_ofs << "ROOT_0 -> " << child << '_' << c << ' ' << 0.25 * rnd.nextDouble() << '\n';
+        }
+    }
+}
+
+// random sentences including unknown words
+vector<vector<string> > makeSentences() {
+    Random rnd(11);
+    vector<string> vocab;
+    for (const auto & pos : POS_WORDS) {
+        for (const string & w : pos.second) {
+            if (w.compare(0, 3, "UNK")) vocab.push_back(w);
+        }
+    }
+    for (const char * w : { "Zorglub", "blorfs", "frobbed", "snarking", "12,000", "IBM" }) {
+        vocab.push_back(w);
+    }
+
+    vector<vector<string> > sentences;
+    sentences.push_back(vector<string>()); // empty line
+    for (int i = 0; i < NUM_SENTENCES; ++i) {
+        vector<string> words(1 + rnd.nextInt(20));
+        for (string & w : words) {
+            w = vocab[rnd.nextInt(vocab.size())];
+        }
+        sentences.push_back(words);
+    }
+    return sentences;
+}
+
+shared_ptr<LAPCFGParser> loadParser(const string & prefix) {
+    shared_ptr<LAPCFGParser> parser = LAPCFGParser::loadFromBerkeleyDump(prefix, 1e-10, "harmonic");
+    parser->setScoreKernel(ScoreKernelFactory::create("auto"));
+    return parser;
+}
+
+// parse all sentences NUM_ROUNDS times on each of NUM_THREADS threads in different
+// orders, and also by concurrent parseBatch() calls sharing 1 scheduler.
+// returns the number of results which differ from expected.
+int runConcurrently(
+    const LAPCFGParser & parser,
+    const vector<vector<string> > & sentences,
+    const vector<string> & expected) {
+
+    const ParserSetting setting { false, false };
+    const SExprFormatter formatter(false);
+    atomic<int> num_errors(0);
+    mutex error_mutex;
+    string first_error;
+
+    auto report = [&](const string & message) {
+        lock_guard<mutex> lock(error_mutex);
+        if (num_errors++ == 0) first_error = message;
+    };
+
+    vector<thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.push_back(thread([&, t]() {
+            try {
+                for (int round = 0; round < NUM_ROUNDS; ++round) {
+                    for (size_t k = 0; k < sentences.size(); ++k) {
+                        const size_t i = (k + 7 * t + round) % sentences.size();
+                        string repr = formatter.generate(*parser.parse(sentences[i], setting).best_parse);
+                        if (repr != expected[i]) {
+                            report((boost::format("sentence %d: %s != %s") % i % repr % expected[i]).str());
+                        }
+                    }
+                }
+            } catch (exception & ex) {
+                report(string("parse() threw: ") + ex.what());
+            }
+        }));
+    }
+
+    BatchScheduler scheduler(NUM_THREADS / 2);
+    for (int t = 0; t < 2; ++t) {
+        threads.push_back(thread([&]() {
+            try {
+                ParserBatchOptions options;
+                options.scheduler = &scheduler;
+                vector<ParserResult> results = parser.parseBatch(sentences, setting, options);
+                for (size_t i = 0; i < sentences.size(); ++i) {
+                    string repr = formatter.generate(*results[i].best_parse);
+                    if (repr != expected[i]) {
+                        report((boost::format("batch sentence %d: %s != %s") % i % repr % expected[i]).str());
+                    }
+                }
+            } catch (exception & ex) {
+                report(string("parseBatch() threw: ") + ex.what());
+            }
+        }));
+    }
+
+    for (thread & th : threads) {
+        th.join();
+    }
+    if (num_errors > 0) {
+        cerr << "  first error: " << first_error << endl;
+    }
+    return num_errors;
+}
+
+} // namespace
+
+int main() {
+    char dir_template[] = "/tmp/ckylark-test-XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        cerr << "cannot create a temporary directory" << endl;
+        return 1;
+    }
+    const string dir = dir_template;
+    const string prefix = dir + "/model";
+
+    int status = 0;
+    try {
+        writeModel(prefix);
+        const vector<vector<string> > sentences = makeSentences();
+        const ParserSetting setting { false, false };
+        const SExprFormatter formatter(false);
+
+        // single-threaded reference
+        vector<string> expected;
+        int num_succeeded = 0;
+        {
+            shared_ptr<LAPCFGParser> parser = loadParser(prefix);
+            for (const vector<string> & sentence : sentences) {
+                ParserResult result = parser->parse(sentence, setting);
+                expected.push_back(formatter.generate(*result.best_parse));
+                if (result.succeeded && result.final_level == parser->getFineLevel()) ++num_succeeded;
+            }
+        }
+        cerr << boost::format("reference: %d of %d sentences parsed at the finest level") % num_succeeded % sentences.size() << endl;
+        if (num_succeeded < NUM_SENTENCES / 2) {
+            throw runtime_error((boost::format("only %d sentences are parsed at the finest level") % num_succeeded).str());
+        }
+
+        // a fresh parser for each setting, so lazy model preparation also runs concurrently
+        for (int span_threads : { 1, 4 }) {
+            shared_ptr<LAPCFGParser> parser = loadParser(prefix);
+            parser->setNumSpanThreads(span_threads);
+            int num_errors = runConcurrently(*parser, sentences, expected);
+            cerr << boost::format("span-threads %d: %d mismatches") % span_threads % num_errors << endl;
+            if (num_errors > 0) status = 1;
+        }
+    } catch (exception & ex) {
+        cerr << "ERROR: " << ex.what() << endl;
+        status = 1;
+    }
+
+    for (const char * ext : { ".words", ".splits", ".lexicon", ".grammar" }) {
+        unlink((prefix + ext).c_str());
+    }
+    rmdir(dir.c_str());
+
+    return status;
+}